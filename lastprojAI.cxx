@@ -10,9 +10,334 @@
 #include <fstream>
 #include <unordered_map>
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <iomanip>
+#include <sstream>
+#include <future>
+#include <cstring>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CHECKERS_HAVE_MMAP
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+#define CHECKERS_HAVE_PROCESSES
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#define CHECKERS_HAVE_PERF_EVENTS
+#endif
+
+// نسخه‌های AVX2/BMI2/SSE4.2 با attribute target ساخته می‌شوند و در زمان اجرا انتخاب می‌شوند؛
+// NNUE_USE_* فقط ISA پایه زمان کامپایل (مثلاً build با -march=native) را نشان می‌دهد
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define CHECKERS_X86
+#define CHECKERS_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_USE_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NNUE_USE_SSE2
+#endif
 
 using namespace std;
 
+// ============================================================================
+// شمارش تخصیص حافظه (فقط در build سنجه: -DCHECKERS_BENCH)
+// ============================================================================
+
+#ifdef CHECKERS_BENCH
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static atomic<unsigned long long> g_allocation_count(0);
+
+void* operator new(size_t size) {
+    g_allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+const bool ALLOCATION_COUNTING = true;
+unsigned long long allocationCount() { return g_allocation_count.load(memory_order_relaxed); }
+#else
+const bool ALLOCATION_COUNTING = false;
+unsigned long long allocationCount() { return 0; }
+#endif
+
+// ============================================================================
+// ردیابی مسیرهای داغ (فقط در build ردیابی: -DCHECKERS_TRACE)
+// ============================================================================
+
+// TraceSpan از ساخت تا تخریب یک رویداد کامل ("ph":"X") در قالب trace-event کروم
+// ثبت می‌کند. رویدادها در بافر هر نخ جمع و هنگام خروج در checkers_trace.json
+// (یا مسیر CHECKERS_TRACE_FILE) نوشته می‌شوند؛ فایل در chrome://tracing یا Perfetto باز می‌شود.
+// در build عادی TraceSpan خالی است و کامپایلر آن را کاملاً حذف می‌کند.
+#ifdef CHECKERS_TRACE
+const bool TRACING = true;
+
+struct TraceEvent {
+    static const int MAX_ARGS = 6;
+    const char* name;
+    const char* category;
+    long long start_ns;
+    long long duration_ns;
+    int arg_count = 0;
+    array<pair<const char*, long long>, MAX_ARGS> args;
+};
+
+class TraceRecorder {
+private:
+    static const size_t MAX_EVENTS_PER_THREAD = size_t(1) << 20;
+    
+    struct ThreadBuffer {
+        int tid;
+        vector<TraceEvent> events;
+        unsigned long long dropped = 0;
+    };
+    
+    mutex buffers_mutex;
+    vector<unique_ptr<ThreadBuffer>> buffers;      // بافرها تا پایان برنامه زنده می‌مانند
+    chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr) {
+            lock_guard<mutex> lock(buffers_mutex);
+            buffers.push_back(make_unique<ThreadBuffer>());
+            buffer = buffers.back().get();
+            buffer->tid = static_cast<int>(buffers.size());
+        }
+        return *buffer;
+    }
+    
+public:
+    static TraceRecorder& instance() {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+    
+    ~TraceRecorder() {
+        const char* path = getenv("CHECKERS_TRACE_FILE");
+        write(path != nullptr ? path : "checkers_trace.json");
+    }
+    
+    long long now() const {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
+    }
+    
+    long long toTraceTime(chrono::steady_clock::time_point t) const {
+        return chrono::duration_cast<chrono::nanoseconds>(t - origin).count();
+    }
+    
+    void record(const TraceEvent& event) {
+        ThreadBuffer& buffer = threadBuffer();
+        if (buffer.events.size() < MAX_EVENTS_PER_THREAD) {
+            buffer.events.push_back(event);
+        } else {
+            buffer.dropped++;
+        }
+    }
+    
+    bool write(const string& filename) {
+        lock_guard<mutex> lock(buffers_mutex);
+        ofstream out(filename);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << fixed << setprecision(3) << "{\"traceEvents\":[";
+        bool first = true;
+        unsigned long long dropped = 0;
+        for (const auto& buffer : buffers) {
+            dropped += buffer->dropped;
+            for (const auto& event : buffer->events) {
+                out << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                    << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"ts\":" << event.start_ns / 1000.0 << ",\"dur\":" << event.duration_ns / 1000.0;
+                if (event.arg_count > 0) {
+                    out << ",\"args\":{";
+                    for (int i = 0; i < event.arg_count; i++) {
+                        out << (i ? "," : "") << "\"" << event.args[i].first << "\":" << event.args[i].second;
+                    }
+                    out << "}";
+                }
+                out << "}";
+                first = false;
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+        return out.good();
+    }
+};
+
+class TraceSpan {
+private:
+    TraceEvent event;
+    
+public:
+    TraceSpan(const char* name, const char* category) {
+        event.name = name;
+        event.category = category;
+        event.start_ns = TraceRecorder::instance().now();
+    }
+    
+    ~TraceSpan() {
+        event.duration_ns = TraceRecorder::instance().now() - event.start_ns;
+        TraceRecorder::instance().record(event);
+    }
+    
+    void arg(const char* key, long long value) {
+        if (event.arg_count < TraceEvent::MAX_ARGS) {
+            event.args[event.arg_count++] = {key, value};
+        }
+    }
+    
+    // شروع زودتر از ساخت (برای بازه‌ای که نقطه شروعش جای دیگری ثبت شده)
+    void setStart(chrono::steady_clock::time_point start) {
+        event.start_ns = TraceRecorder::instance().toTraceTime(start);
+    }
+};
+#else
+const bool TRACING = false;
+
+class TraceSpan {
+public:
+    TraceSpan(const char*, const char*) {}
+    void arg(const char*, long long) {}
+    void setStart(chrono::steady_clock::time_point) {}
+};
+#endif
+
+// ============================================================================
+// شمارنده‌های سخت‌افزاری (perf_event_open در لینوکس)
+// ============================================================================
+
+struct HardwareCounterValues {
+    bool valid = false;                  // false: شمارنده‌ها در دسترس نبودند
+    long long cycles = 0;
+    long long instructions = 0;
+    long long cache_misses = 0;
+    long long branch_misses = 0;
+    
+    double ipc() const { return cycles > 0 ? static_cast<double>(instructions) / cycles : 0.0; }
+};
+
+// یک گروه چهارتایی برای نخ جاری (فقط فضای کاربر). در نبود مجوز
+// (perf_event_paranoid) یا خارج از لینوکس، stop مقدار نامعتبر برمی‌گرداند.
+class HardwareCounters {
+private:
+    static const int COUNT = 4;
+    int fds[COUNT] = {-1, -1, -1, -1};
+    bool opened = false;
+    bool available = false;
+    
+#ifdef CHECKERS_HAVE_PERF_EVENTS
+    void open() {
+        opened = true;
+        const uint64_t configs[COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                         PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int i = 0; i < COUNT; i++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+            if (fds[i] < 0) {
+                close();
+                return;
+            }
+        }
+        available = true;
+    }
+    
+    void close() {
+        for (int& fd : fds) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    }
+#endif
+    
+public:
+    HardwareCounters() = default;
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+    
+#ifdef CHECKERS_HAVE_PERF_EVENTS
+    ~HardwareCounters() { close(); }
+    
+    void start() {
+        if (!opened) open();
+        if (!available) return;
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    
+    HardwareCounterValues stop() {
+        HardwareCounterValues values;
+        if (!available) return values;
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t data[1 + COUNT];
+        if (::read(fds[0], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) && data[0] == COUNT) {
+            values.valid = true;
+            values.cycles = static_cast<long long>(data[1]);
+            values.instructions = static_cast<long long>(data[2]);
+            values.cache_misses = static_cast<long long>(data[3]);
+            values.branch_misses = static_cast<long long>(data[4]);
+        }
+        return values;
+    }
+#else
+    void start() {}
+    HardwareCounterValues stop() { return HardwareCounterValues(); }
+#endif
+    
+    // شمارنده‌های نخ جاری؛ یک بار باز می‌شوند و تا پایان نخ می‌مانند
+    static HardwareCounters& forThread() {
+        thread_local HardwareCounters counters;
+        return counters;
+    }
+};
+
 // ============================================================================
 // ساختارها و ثابت‌ها
 // ============================================================================
@@ -63,1161 +388,8241 @@ struct Move {
 };
 
 // جهت‌های حرکت
-const vector<Position> BLACK_DIRECTIONS = {{-1, -1}, {-1, 1}};
-const vector<Position> WHITE_DIRECTIONS = {{1, -1}, {1, 1}};
+// سیاه از ردیف‌های 0 و 1 شروع می‌کند و در ردیف 5 شاه می‌شود؛ سفید برعکس
+const vector<Position> BLACK_DIRECTIONS = {{1, -1}, {1, 1}};
+const vector<Position> WHITE_DIRECTIONS = {{-1, -1}, {-1, 1}};
 const vector<Position> KING_DIRECTIONS = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
 
+// نمایش حرکت به شکل r,c-r,c[-r,c...]
+string moveToString(const Move& move) {
+    string text = to_string(move.from.row) + "," + to_string(move.from.col);
+    for (const auto& step : move.to) {
+        text += (move.is_capture ? "x" : "-") + to_string(step.row) + "," + to_string(step.col);
+    }
+    return text;
+}
+
 // ============================================================================
-// کلاس بازی Checkers
+// تولید اعداد تصادفی قطعی (xoshiro256**) با جریان‌های مشتق از بذر اصلی
 // ============================================================================
 
-class CheckersGame {
+// SplitMix64: پخش بذر و ساخت جریان‌های مستقل
+inline uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// بذر جریان stream (بازی، نخ، ...) از بذر اصلی
+inline uint64_t deriveSeed(uint64_t master_seed, uint64_t stream) {
+    uint64_t state = master_seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    splitMix64(state);
+    return splitMix64(state);
+}
+
+// xoshiro256**: سریع، بدون وضعیت مشترک؛ هر نخ/عامل نمونه خود را دارد
+class Xoshiro256 {
 private:
-    static const int BOARD_SIZE = 6;
-    array<array<PieceType, BOARD_SIZE>, BOARD_SIZE> board;
-    PieceType current_player;
-    bool game_over;
-    PieceType winner;
-    vector<Move> move_history;
-    
-    // تولید کننده اعداد تصادفی
-    static mt19937 rng;
-    
+    array<uint64_t, 4> s;
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
 public:
-    // سازنده
-    CheckersGame() {
-        initializeBoard();
-        current_player = PieceType::BLACK_PIECE;
-        game_over = false;
-        winner = PieceType::EMPTY;
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 1) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        uint64_t state = seed;
+        for (auto& word : s) {
+            word = splitMix64(state);
+        }
     }
-    
-    // کپی سازنده
-    CheckersGame(const CheckersGame& other) {
-        board = other.board;
-        current_player = other.current_player;
-        game_over = other.game_over;
-        winner = other.winner;
-        move_history = other.move_history;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return numeric_limits<uint64_t>::max(); }
+
+    result_type operator()() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
     }
-    
-    // مقداردهی اولیه صفحه
-    void initializeBoard() {
-        // پر کردن با خانه‌های خالی
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                board[i][j] = PieceType::EMPTY;
-            }
-        }
-        
-        // قرار دادن مهره‌های سیاه (ردیف‌های 0 و 1)
-        for (int row = 0; row < 2; row++) {
-            for (int col = 0; col < BOARD_SIZE; col++) {
-                if ((row + col) % 2 == 1) {
-                    board[row][col] = PieceType::BLACK_PIECE;
-                }
-            }
-        }
-        
-        // قرار دادن مهره‌های سفید (ردیف‌های 4 و 5)
-        for (int row = 4; row < BOARD_SIZE; row++) {
-            for (int col = 0; col < BOARD_SIZE; col++) {
-                if ((row + col) % 2 == 1) {
-                    board[row][col] = PieceType::WHITE_PIECE;
-                }
-            }
+
+    // عدد صحیح یکنواخت در [0, n) — مستقل از پیاده‌سازی کتابخانه استاندارد
+    uint64_t below(uint64_t n) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>((*this)()) * n) >> 64);
+    }
+
+    // عدد اعشاری یکنواخت در [0, 1)
+    double nextDouble() {
+        return ((*this)() >> 11) * 0x1.0p-53;
+    }
+};
+
+// ============================================================================
+// انتخاب هسته‌ها در زمان اجرا بر اساس قابلیت‌های CPU
+// ============================================================================
+
+// یک باینری برای همه گره‌ها: هسته‌های داغ در چند نسخه ISA کامپایل می‌شوند و هنگام
+// شروع بهترین نسخه‌ای که CPU پشتیبانی می‌کند انتخاب می‌شود. سطح‌ها تجمعی‌اند؛
+// CHECKERS_ISA=baseline|sse4.2|avx2|bmi2 سطح انتخابی را محدود می‌کند (برای مقایسه و اشکال‌زدایی).
+enum class IsaLevel { BASELINE = 0, SSE42 = 1, AVX2 = 2, BMI2 = 3 };
+
+const char* isaName(IsaLevel level) {
+    switch (level) {
+        case IsaLevel::SSE42: return "sse4.2";
+        case IsaLevel::AVX2: return "avx2";
+        case IsaLevel::BMI2: return "bmi2";
+        default: return "baseline";
+    }
+}
+
+bool parseIsaLevel(const string& name, IsaLevel& level) {
+    for (IsaLevel candidate : {IsaLevel::BASELINE, IsaLevel::SSE42, IsaLevel::AVX2, IsaLevel::BMI2}) {
+        if (name == isaName(candidate)) {
+            level = candidate;
+            return true;
         }
     }
+    return false;
+}
+
+struct CpuFeatures {
+    bool sse42 = false;
+    bool popcnt = false;
+    bool avx2 = false;
+    bool bmi2 = false;
+    bool slow_pext = false;     // Zen 1/2: PEXT با microcode، کندتر از حلقه ساده
     
-    // بررسی معتبر بودن موقعیت
-    bool isValidPosition(const Position& pos) const {
-        return pos.row >= 0 && pos.row < BOARD_SIZE && 
-               pos.col >= 0 && pos.col < BOARD_SIZE &&
-               board[pos.row][pos.col] != PieceType::INVALID;
+    static const CpuFeatures& host() {
+        static const CpuFeatures features = detect();
+        return features;
     }
     
-    // بررسی خانه سیاه (قابل بازی)
-    bool isBlackSquare(const Position& pos) const {
-        return (pos.row + pos.col) % 2 == 1;
+    IsaLevel best() const {
+        if (avx2 && bmi2 && !slow_pext) return IsaLevel::BMI2;
+        if (avx2) return IsaLevel::AVX2;
+        if (sse42 && popcnt) return IsaLevel::SSE42;
+        return IsaLevel::BASELINE;
     }
     
-    // دریافت رنگ مهره
-    PieceType getPieceColor(PieceType piece) const {
-        if (piece == PieceType::BLACK_PIECE || piece == PieceType::BLACK_KING) {
-            return PieceType::BLACK_PIECE;
-        } else if (piece == PieceType::WHITE_PIECE || piece == PieceType::WHITE_KING) {
-            return PieceType::WHITE_PIECE;
-        }
-        return PieceType::EMPTY;
+    string describe() const {
+        string text;
+        if (sse42) text += "sse4.2 ";
+        if (popcnt) text += "popcnt ";
+        if (avx2) text += "avx2 ";
+        if (bmi2) text += slow_pext ? "bmi2(slow pext) " : "bmi2 ";
+        return text.empty() ? "none" : text.substr(0, text.size() - 1);
     }
     
-    // بررسی شاه بودن
-    bool isKing(PieceType piece) const {
-        return piece == PieceType::BLACK_KING || piece == PieceType::WHITE_KING;
+private:
+    static CpuFeatures detect() {
+        CpuFeatures features;
+#ifdef CHECKERS_X86
+        __builtin_cpu_init();
+        features.sse42 = __builtin_cpu_supports("sse4.2");
+        features.popcnt = __builtin_cpu_supports("popcnt");
+        features.avx2 = __builtin_cpu_supports("avx2");
+        features.bmi2 = __builtin_cpu_supports("bmi2");
+        features.slow_pext = __builtin_cpu_is("znver1") || __builtin_cpu_is("znver2");
+#endif
+        return features;
     }
-    
-    // دریافت تمام حرکات معتبر برای بازیکن
-    vector<Move> getAllValidMoves(PieceType player) const {
-        vector<Move> moves;
-        vector<Move> capture_moves;
-        
-        for (int row = 0; row < BOARD_SIZE; row++) {
-            for (int col = 0; col < BOARD_SIZE; col++) {
-                Position pos(row, col);
-                PieceType piece = board[row][col];
-                
-                if (getPieceColor(piece) == player) {
-                    vector<Move> piece_moves = getMovesForPiece(pos, piece);
-                    
-                    for (const auto& move : piece_moves) {
-                        if (move.is_capture) {
-                            capture_moves.push_back(move);
-                        } else {
-                            moves.push_back(move);
-                        }
-                    }
-                }
-            }
+};
+
+struct BoardBatch;
+struct BoardBatchResult;
+
+// جدول هسته‌ها؛ هر سطح ISA یک نمونه دارد (kernelsFor، پس از تعریف همه هسته‌ها)
+struct EngineKernels {
+    IsaLevel isa = IsaLevel::BASELINE;
+    // out[r] = sum_k input[k] * weights[r][k] برای rows سطر NNUE_HIDDEN تایی (لایه دوم NNUE)
+    void (*nnue_dot_rows)(const int16_t* input, const int16_t* weights, int rows, int32_t* out) = nullptr;
+    // شکل فشرده CheckersGame::pack به ستون‌های BoardBatch
+    void (*unpack_boards)(const uint64_t* packed, size_t count, BoardBatch& batch) = nullptr;
+    // حرکت‌ها، captureها و ماده همه خطوط دسته
+    void (*analyze_lanes)(const BoardBatch& batch, BoardBatchResult& out) = nullptr;
+    // y += a * x و sum(x * y) برای تیونر Texel
+    void (*axpy)(float* y, const float* x, float a, size_t n) = nullptr;
+    double (*dot)(const float* x, const float* y, size_t n) = nullptr;
+    // هش کلید صفحه (جدول تجربه LearningAgent)
+    uint64_t (*hash_bytes)(const char* data, size_t n) = nullptr;
+};
+
+const EngineKernels& kernelsFor(IsaLevel level);
+
+// سطح انتخابی: بهترین سطح CPU، محدود به CHECKERS_ISA
+IsaLevel selectedIsa() {
+    static const IsaLevel level = []() {
+        IsaLevel best = CpuFeatures::host().best();
+        IsaLevel cap = best;
+        const char* env = getenv("CHECKERS_ISA");
+        if (env && *env && !parseIsaLevel(env, cap)) {
+            cerr << "CHECKERS_ISA: unknown level '" << env << "', using " << isaName(best) << endl;
         }
-        
-        // اگر حرکت capture وجود دارد، فقط آن‌ها را برگردان
-        if (!capture_moves.empty()) {
-            // پیدا کردن بیشترین تعداد capture
-            int max_captures = 0;
-            for (const auto& move : capture_moves) {
-                if (move.capture_count > max_captures) {
-                    max_captures = move.capture_count;
-                }
-            }
-            
-            // فقط حرکات با بیشترین capture
-            vector<Move> result;
-            for (const auto& move : capture_moves) {
-                if (move.capture_count == max_captures) {
-                    result.push_back(move);
-                }
-            }
-            return result;
+        return min(best, cap);
+    }();
+    return level;
+}
+
+const EngineKernels& kernels() {
+    static const EngineKernels& selected = kernelsFor(selectedIsa());
+    return selected;
+}
+
+// هسته‌های کوچک باید در نسخه target دار فراخوان inline شوند تا با همان ISA کامپایل شوند
+#define CHECKERS_INLINE inline __attribute__((always_inline))
+
+// هش پایه: همان هش کتابخانه استاندارد برای رشته‌ها
+uint64_t hashBytesDefault(const char* data, size_t n) {
+    return hash<string_view>()(string_view(data, n));
+}
+
+#ifdef CHECKERS_X86
+// CRC32C سخت‌افزاری روی کلمه‌های 8 بایتی و ضرب برای پخش بیت‌ها در 64 بیت
+CHECKERS_TARGET("sse4.2") uint64_t hashBytesCrc32(const char* data, size_t n) {
+    uint64_t crc = 0xFFFFFFFFu;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        crc = _mm_crc32_u64(crc, word);
+    }
+    for (; i < n; i++) {
+        crc = _mm_crc32_u8(static_cast<uint32_t>(crc), static_cast<uint8_t>(data[i]));
+    }
+    return (crc ^ (static_cast<uint64_t>(n) << 32)) * 0x9E3779B97F4A7C15ULL;
+}
+#endif
+
+// برای unordered_map با کلید رشته صفحه
+struct BoardKeyHash {
+    size_t operator()(const string& key) const {
+        return static_cast<size_t>(kernels().hash_bytes(key.data(), key.size()));
+    }
+};
+
+// ============================================================================
+// شبکه عصبی کوچک (NNUE) با لایه اول افزایشی
+// ============================================================================
+
+// ورودی: 18 خانه قابل بازی × 4 نوع مهره؛ لایه اول به صورت افزایشی نگه‌داری می‌شود
+const int NNUE_SQUARES = 18;
+const int NNUE_INPUTS = NNUE_SQUARES * 4;
+const int NNUE_HIDDEN = 32;
+const int NNUE_L1 = 16;
+const int NNUE_L1_SHIFT = 6;
+const int NNUE_CLIP = 127;
+const double NNUE_OUTPUT_SCALE = 4.0;
+
+struct NNUEAccumulator {
+    alignas(32) array<int16_t, NNUE_HIDDEN> values;
+};
+
+// لایه دوم: ضرب داخلی ورودی بریده‌شده (0..127) در هر سطر وزن؛ ورودی و سطرها 32 بایتی هم‌ترازند
+void nnueDotRowsScalar(const int16_t* input, const int16_t* weights, int rows, int32_t* out) {
+    for (int r = 0; r < rows; r++, weights += NNUE_HIDDEN) {
+        int32_t sum = 0;
+        for (int k = 0; k < NNUE_HIDDEN; k++) {
+            sum += static_cast<int32_t>(input[k]) * weights[k];
         }
-        
-        return moves;
+        out[r] = sum;
     }
-    
-    // دریافت حرکات برای یک مهره خاص
-    vector<Move> getMovesForPiece(const Position& pos, PieceType piece) const {
-        vector<Move> moves;
-        
-        // تعیین جهت‌های حرکت
-        vector<Position> directions;
-        if (isKing(piece)) {
-            directions = KING_DIRECTIONS;
-        } else if (piece == PieceType::BLACK_PIECE) {
-            directions = BLACK_DIRECTIONS;
-        } else {
-            directions = WHITE_DIRECTIONS;
+}
+
+#if defined(__SSE2__)
+void nnueDotRowsSse2(const int16_t* input, const int16_t* weights, int rows, int32_t* out) {
+    for (int r = 0; r < rows; r++, weights += NNUE_HIDDEN) {
+        __m128i sum = _mm_setzero_si128();
+        for (int k = 0; k < NNUE_HIDDEN; k += 8) {
+            __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(input + k));
+            __m128i w = _mm_load_si128(reinterpret_cast<const __m128i*>(weights + k));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(x, w));
         }
-        
-        // بررسی حرکات capture
-        vector<Move> capture_moves = getCaptureMoves(pos, piece, directions);
-        if (!capture_moves.empty()) {
-            return capture_moves;
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        out[r] = _mm_cvtsi128_si32(sum);
+    }
+}
+#endif
+
+#ifdef CHECKERS_X86
+CHECKERS_TARGET("avx2") void nnueDotRowsAvx2(const int16_t* input, const int16_t* weights, int rows, int32_t* out) {
+    static_assert(NNUE_HIDDEN % 16 == 0, "AVX2 rows are 16 weights wide");
+    for (int r = 0; r < rows; r++, weights += NNUE_HIDDEN) {
+        __m256i sum = _mm256_setzero_si256();
+        for (int k = 0; k < NNUE_HIDDEN; k += 16) {
+            __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + k));
+            __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + k));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, w));
         }
-        
-        // حرکات ساده
-        return getSimpleMoves(pos, piece, directions);
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        out[r] = _mm_cvtsi128_si32(s);
     }
-    
-    // حرکات ساده
-    vector<Move> getSimpleMoves(const Position& pos, PieceType piece, 
-                               const vector<Position>& directions) const {
-        vector<Move> moves;
-        
-        for (const auto& dir : directions) {
-            Position new_pos(pos.row + dir.row, pos.col + dir.col);
-            
-            if (isValidPosition(new_pos) && board[new_pos.row][new_pos.col] == PieceType::EMPTY) {
-                Move move;
-                move.from = pos;
-                move.to.push_back(new_pos);
-                move.is_capture = false;
-                move.capture_count = 0;
-                move.becomes_king = shouldBecomeKing(new_pos, piece);
-                moves.push_back(move);
+}
+#endif
+
+class NNUENetwork {
+private:
+    alignas(32) array<array<int16_t, NNUE_HIDDEN>, NNUE_INPUTS> ft_weights;
+    alignas(32) array<int16_t, NNUE_HIDDEN> ft_bias;
+    alignas(32) array<array<int16_t, NNUE_HIDDEN>, NNUE_L1> l1_weights;
+    array<int32_t, NNUE_L1> l1_bias;
+    array<int32_t, NNUE_L1> out_weights;
+    int32_t out_bias;
+
+    // acc += row یا acc -= row
+    static void addRow(NNUEAccumulator& acc, const array<int16_t, NNUE_HIDDEN>& row, bool subtract) {
+#if defined(NNUE_USE_AVX2)
+        for (int k = 0; k < NNUE_HIDDEN; k += 16) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(&acc.values[k]));
+            __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(&row[k]));
+            a = subtract ? _mm256_sub_epi16(a, w) : _mm256_add_epi16(a, w);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&acc.values[k]), a);
+        }
+#elif defined(NNUE_USE_SSE2)
+        for (int k = 0; k < NNUE_HIDDEN; k += 8) {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(&acc.values[k]));
+            __m128i w = _mm_load_si128(reinterpret_cast<const __m128i*>(&row[k]));
+            a = subtract ? _mm_sub_epi16(a, w) : _mm_add_epi16(a, w);
+            _mm_store_si128(reinterpret_cast<__m128i*>(&acc.values[k]), a);
+        }
+#else
+        for (int k = 0; k < NNUE_HIDDEN; k++) {
+            acc.values[k] = subtract ? acc.values[k] - row[k] : acc.values[k] + row[k];
+        }
+#endif
+    }
+
+public:
+    NNUENetwork() { setDefaultWeights(); }
+
+    // شماره ورودی برای یک مهره روی خانه (row, col)
+    static int featureIndex(int row, int col, PieceType piece) {
+        return (row * 3 + col / 2) * 4 + (static_cast<int>(piece) - 1);
+    }
+
+    static bool isPiece(PieceType piece) {
+        return piece != PieceType::EMPTY && piece != PieceType::INVALID;
+    }
+
+    // وزن‌های پیش‌فرض: شبکه‌ای معادل ارزیابی مادی evaluateBasic
+    void setDefaultWeights() {
+        for (auto& row : ft_weights) row.fill(0);
+        ft_bias.fill(0);
+        for (auto& row : l1_weights) row.fill(0);
+        l1_bias.fill(0);
+        out_weights.fill(0);
+        out_bias = 0;
+
+        for (int sq = 0; sq < NNUE_SQUARES; sq++) {
+            ft_weights[sq * 4 + 0][0] = 4;   // مهره سیاه
+            ft_weights[sq * 4 + 2][0] = 12;  // شاه سیاه
+            ft_weights[sq * 4 + 1][1] = 4;   // مهره سفید
+            ft_weights[sq * 4 + 3][1] = 12;  // شاه سفید
+        }
+        l1_weights[0][0] = 1 << NNUE_L1_SHIFT;
+        l1_weights[1][1] = 1 << NNUE_L1_SHIFT;
+        out_weights[0] = 1;
+        out_weights[1] = -1;
+    }
+
+    // محاسبه کامل accumulator از روی صفحه
+    template <typename Board>
+    void refresh(const Board& board, NNUEAccumulator& acc) const {
+        acc.values = ft_bias;
+        for (int i = 0; i < 6; i++) {
+            for (int j = 0; j < 6; j++) {
+                if ((i + j) % 2 == 1 && isPiece(board[i][j])) {
+                    addRow(acc, ft_weights[featureIndex(i, j, board[i][j])], false);
+                }
             }
         }
+    }
+
+    void addPiece(NNUEAccumulator& acc, const Position& pos, PieceType piece) const {
+        addRow(acc, ft_weights[featureIndex(pos.row, pos.col, piece)], false);
+    }
+
+    void removePiece(NNUEAccumulator& acc, const Position& pos, PieceType piece) const {
+        addRow(acc, ft_weights[featureIndex(pos.row, pos.col, piece)], true);
+    }
+
+    // خروجی شبکه از دید سیاه (واحد: مهره معمولی)
+    double evaluate(const NNUEAccumulator& acc) const {
+        alignas(32) array<int16_t, NNUE_HIDDEN> clipped;
+        for (int k = 0; k < NNUE_HIDDEN; k++) {
+            clipped[k] = static_cast<int16_t>(min<int>(max<int>(acc.values[k], 0), NNUE_CLIP));
+        }
+
+        array<int32_t, NNUE_L1> dots;
+        kernels().nnue_dot_rows(clipped.data(), l1_weights[0].data(), NNUE_L1, dots.data());
         
-        return moves;
+        int32_t output = out_bias;
+        for (int n = 0; n < NNUE_L1; n++) {
+            int32_t hidden = (dots[n] + l1_bias[n]) >> NNUE_L1_SHIFT;
+            hidden = min(max(hidden, 0), NNUE_CLIP);
+            output += hidden * out_weights[n];
+        }
+        return output / NNUE_OUTPUT_SCALE;
+    }
+
+    // فایل وزن: "CKNN"، نسخه، سپس آرایه‌ها به ترتیب تعریف
+    bool saveWeights(const string& filename) const {
+        ofstream file(filename, ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        const uint32_t version = 1;
+        file.write("CKNN", 4);
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&ft_weights), sizeof(ft_weights));
+        file.write(reinterpret_cast<const char*>(&ft_bias), sizeof(ft_bias));
+        file.write(reinterpret_cast<const char*>(&l1_weights), sizeof(l1_weights));
+        file.write(reinterpret_cast<const char*>(&l1_bias), sizeof(l1_bias));
+        file.write(reinterpret_cast<const char*>(&out_weights), sizeof(out_weights));
+        file.write(reinterpret_cast<const char*>(&out_bias), sizeof(out_bias));
+        return file.good();
+    }
+
+    bool loadWeights(const string& filename) {
+        ifstream file(filename, ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        char magic[4];
+        uint32_t version = 0;
+        file.read(magic, 4);
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (!file || string(magic, 4) != "CKNN" || version != 1) {
+            return false;
+        }
+
+        NNUENetwork loaded;
+        file.read(reinterpret_cast<char*>(&loaded.ft_weights), sizeof(ft_weights));
+        file.read(reinterpret_cast<char*>(&loaded.ft_bias), sizeof(ft_bias));
+        file.read(reinterpret_cast<char*>(&loaded.l1_weights), sizeof(l1_weights));
+        file.read(reinterpret_cast<char*>(&loaded.l1_bias), sizeof(l1_bias));
+        file.read(reinterpret_cast<char*>(&loaded.out_weights), sizeof(out_weights));
+        file.read(reinterpret_cast<char*>(&loaded.out_bias), sizeof(out_bias));
+        if (!file) {
+            return false;
+        }
+        *this = loaded;
+        return true;
+    }
+};
+
+// ============================================================================
+// کلیدهای Zobrist برای هش موقعیت
+// ============================================================================
+
+template<int N>
+struct ZobristKeys {
+    array<array<uint64_t, 5>, N * N> piece; // [row*N+col][PieceType]
+    uint64_t side;                          // نوبت سفید
+
+    ZobristKeys() {
+        uint64_t state = 0x5A0B81ED5EEDULL; // ثابت: هش‌ها بین اجراها یکسان‌اند
+        for (auto& square : piece) {
+            square[0] = 0;
+            for (int k = 1; k < 5; k++) {
+                square[k] = splitMix64(state);
+            }
+        }
+        side = splitMix64(state);
+    }
+};
+
+template<int N>
+inline const ZobristKeys<N> ZOBRIST{};
+
+// ============================================================================
+// قواعد بازی (پارامتر قالب CheckersGame)
+// ============================================================================
+
+// قواعد پروژه: صفحه 6x6، بیشترین capture اجباری، مساوی پس از 30 نیم‌حرکت بدون capture
+struct Rules6x6 {
+    static constexpr int SIZE = 6;
+    static constexpr int PIECE_ROWS = 2;            // ردیف‌های مهره هر طرف در شروع
+    static constexpr bool FLYING_KINGS = false;     // شاه در هر فاصله روی قطر حرکت می‌کند
+    static constexpr bool MAX_CAPTURE = true;       // فقط captureهای با بیشترین مهره مجازند
+    static constexpr bool CROWNING_ENDS_MOVE = false; // شاه شدن زنجیره capture را پایان می‌دهد
+    static constexpr int DRAW_PLIES = 30;
+    static constexpr const char* NAME = "6x6";
+};
+
+// Draughts انگلیسی 8x8: هر capture اجباری است (نه لزوماً بیشترین)
+struct RulesEnglish8x8 {
+    static constexpr int SIZE = 8;
+    static constexpr int PIECE_ROWS = 3;
+    static constexpr bool FLYING_KINGS = false;
+    static constexpr bool MAX_CAPTURE = false;
+    static constexpr bool CROWNING_ENDS_MOVE = true;
+    static constexpr int DRAW_PLIES = 80;
+    static constexpr const char* NAME = "8x8";
+};
+
+// گونه 8x8 با شاه پرنده و قانون بیشترین capture
+struct RulesFlying8x8 {
+    static constexpr int SIZE = 8;
+    static constexpr int PIECE_ROWS = 3;
+    static constexpr bool FLYING_KINGS = true;
+    static constexpr bool MAX_CAPTURE = true;
+    static constexpr bool CROWNING_ENDS_MOVE = true;
+    static constexpr int DRAW_PLIES = 80;
+    static constexpr const char* NAME = "flying";
+};
+
+// ============================================================================
+// کلاس بازی Checkers
+// ============================================================================
+
+template<class Rules>
+class BasicCheckersGame {
+public:
+    using RuleSet = Rules;
+    static constexpr int SIZE = Rules::SIZE;
+    using Board = array<array<PieceType, SIZE>, SIZE>;
+    
+private:
+    static constexpr int BOARD_SIZE = SIZE;
+    // accumulator NNUE برای چیدمان 18 خانه‌ای 6x6 تعریف شده است
+    static constexpr bool HAS_NNUE = (SIZE == 6);
+    
+    Board board;
+    PieceType current_player;
+    bool game_over;
+    PieceType winner;
+    vector<Move> move_history;
+    
+    // accumulator لایه اول NNUE (فقط وقتی شبکه متصل باشد)
+    const NNUENetwork* nnue;
+    NNUEAccumulator nnue_acc;
+    
+    // هش Zobrist موقعیت فعلی و پشته هش موقعیت‌های قبلی از آخرین حرکت
+    // برگشت‌ناپذیر (capture یا حرکت مهره ساده)؛ موقعیت پیش از آن تکرارشدنی نیست.
+    // repetition_filter یک فیلتر bloom شصت‌وچهار بیتی روی همان پشته است.
+    uint64_t hash;
+    vector<uint64_t> hash_stack;
+    uint64_t repetition_filter;
+    
+    static uint64_t filterBit(uint64_t h) { return 1ULL << (h >> 58); }
+    
+    uint64_t pieceKey(int row, int col, PieceType piece) const {
+        return ZOBRIST<SIZE>.piece[row * BOARD_SIZE + col][static_cast<int>(piece)];
     }
     
-    // حرکات capture
-    vector<Move> getCaptureMoves(const Position& pos, PieceType piece,
-                                const vector<Position>& directions) const {
-        vector<Move> capture_moves;
+    // پس از تنظیم صفحه از بیرون: نوبت، تاریخچه، هش، NNUE و وضعیت پایان
+    void resetPosition(PieceType to_move) {
+        current_player = to_move;
+        move_history.clear();
+        winner = PieceType::EMPTY;
+        resetHash();
         
-        // تعیین مهره‌های حریف
-        vector<PieceType> opponent_pieces;
-        if (getPieceColor(piece) == PieceType::BLACK_PIECE) {
-            opponent_pieces = {PieceType::WHITE_PIECE, PieceType::WHITE_KING};
-        } else {
-            opponent_pieces = {PieceType::BLACK_PIECE, PieceType::BLACK_KING};
+        if (HAS_NNUE && nnue != nullptr) {
+            nnue->refresh(board, nnue_acc);
         }
         
-        // تابع بازگشتی برای جستجوی زنجیره‌ای
-        function<void(Position, vector<Position>, vector<Position>, vector<Move>&)> 
-        findCaptureChains = [&](Position current_pos, vector<Position> visited_captures,
-                               vector<Position> path, vector<Move>& result) {
-            bool found_chain = false;
-            
-            for (const auto& dir : directions) {
-                Position jump_pos(current_pos.row + dir.row, current_pos.col + dir.col);
-                Position land_pos(jump_pos.row + dir.row, jump_pos.col + dir.col);
-                
-                // بررسی امکان capture
-                if (isValidPosition(jump_pos) && isValidPosition(land_pos)) {
-                    PieceType jumped_piece = board[jump_pos.row][jump_pos.col];
-                    
-                    // بررسی اینکه مهره حریف باشد و قبلاً capture نشده باشد
-                    bool is_opponent = false;
-                    for (auto opp_piece : opponent_pieces) {
-                        if (jumped_piece == opp_piece) {
-                            is_opponent = true;
-                            break;
-                        }
-                    }
-                    
-                    bool already_captured = false;
-                    for (const auto& cap : visited_captures) {
-                        if (cap == jump_pos) {
-                            already_captured = true;
-                            break;
-                        }
-                    }
-                    
-                    if (is_opponent && !already_captured && 
-                        board[land_pos.row][land_pos.col] == PieceType::EMPTY) {
-                        
-                        // به‌روزرسانی مسیر
-                        vector<Position> new_visited = visited_captures;
-                        new_visited.push_back(jump_pos);
-                        vector<Position> new_path = path;
-                        new_path.push_back(land_pos);
-                        vector<Position> new_captured = visited_captures;
-                        new_captured.push_back(jump_pos);
-                        
-                        // جستجوی captureهای بیشتر
-                        vector<Move> further_chains;
-                        findCaptureChains(land_pos, new_visited, new_path, further_chains);
-                        
-                        if (!further_chains.empty()) {
-                            for (auto& chain : further_chains) {
-                                result.push_back(chain);
-                            }
-                        } else {
-                            Move move;
-                            move.from = pos;
-                            move.to = new_path;
-                            move.captured = new_captured;
-                            move.is_capture = true;
-                            move.capture_count = new_captured.size();
-                            move.becomes_king = shouldBecomeKing(land_pos, piece) || isKing(piece);
-                            result.push_back(move);
-                        }
-                        
-                        found_chain = true;
-                    }
+        checkGameOver();
+    }
+    
+    // محاسبه کامل هش (پس از ساخت یا تنظیم صفحه)
+    void resetHash() {
+        hash = (current_player == PieceType::WHITE_PIECE) ? ZOBRIST<SIZE>.side : 0;
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (board[i][j] != PieceType::EMPTY && board[i][j] != PieceType::INVALID) {
+                    hash ^= pieceKey(i, j, board[i][j]);
                 }
             }
-        };
-        
-        vector<Move> chains;
-        findCaptureChains(pos, {}, {}, chains);
-        
-        return chains;
+        }
+        hash_stack.clear();
+        repetition_filter = 0;
     }
     
-    // بررسی تبدیل به شاه
-    bool shouldBecomeKing(const Position& pos, PieceType piece) const {
-        if (piece == PieceType::BLACK_PIECE && pos.row == BOARD_SIZE - 1) {
-            return true;
-        } else if (piece == PieceType::WHITE_PIECE && pos.row == 0) {
-            return true;
-        }
-        return false;
+public:
+    // سازنده
+    BasicCheckersGame() : nnue(nullptr) {
+        nnue_acc.values.fill(0);
+        initializeBoard();
+        current_player = PieceType::BLACK_PIECE;
+        game_over = false;
+        winner = PieceType::EMPTY;
+        resetHash();
     }
     
-    // اعمال حرکت
-    bool applyMove(const Move& move) {
-        if (!isValidPosition(move.from) || move.to.empty()) {
-            return false;
+    // کپی سازنده
+    BasicCheckersGame(const BasicCheckersGame& other) {
+        board = other.board;
+        current_player = other.current_player;
+        game_over = other.game_over;
+        winner = other.winner;
+        move_history = other.move_history;
+        nnue = other.nnue;
+        nnue_acc = other.nnue_acc;
+        hash = other.hash;
+        hash_stack = other.hash_stack;
+        repetition_filter = other.repetition_filter;
+    }
+    
+    BasicCheckersGame& operator=(const BasicCheckersGame& other) = default;
+    
+    // مقداردهی اولیه صفحه
+    void initializeBoard() {
+        // پر کردن با خانه‌های خالی
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                board[i][j] = PieceType::EMPTY;
+            }
         }
         
-        // ذخیره مهره
-        PieceType piece = board[move.from.row][move.from.col];
-        
-        // حذف مهره از مبدأ
-        board[move.from.row][move.from.col] = PieceType::EMPTY;
-        
-        // حذف مهره‌های capture شده
-        for (const auto& cap_pos : move.captured) {
-            board[cap_pos.row][cap_pos.col] = PieceType::EMPTY;
+        // قرار دادن مهره‌های سیاه (ردیف‌های پایین)
+        for (int row = 0; row < Rules::PIECE_ROWS; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                if ((row + col) % 2 == 1) {
+                    board[row][col] = PieceType::BLACK_PIECE;
+                }
+            }
         }
         
-        // قرار دادن مهره در مقصد نهایی
-        Position final_pos = move.to.back();
-        
-        // تبدیل به شاه اگر لازم باشد
-        if (move.becomes_king) {
-            if (getPieceColor(piece) == PieceType::BLACK_PIECE) {
-                board[final_pos.row][final_pos.col] = PieceType::BLACK_KING;
-            } else {
-                board[final_pos.row][final_pos.col] = PieceType::WHITE_KING;
+        // قرار دادن مهره‌های سفید (ردیف‌های بالا)
+        for (int row = BOARD_SIZE - Rules::PIECE_ROWS; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                if ((row + col) % 2 == 1) {
+                    board[row][col] = PieceType::WHITE_PIECE;
+                }
+            }
+        }
+    }
+    
+    // بررسی معتبر بودن موقعیت
+    bool isValidPosition(const Position& pos) const {
+        return pos.row >= 0 && pos.row < BOARD_SIZE && 
+               pos.col >= 0 && pos.col < BOARD_SIZE &&
+               board[pos.row][pos.col] != PieceType::INVALID;
+    }
+    
+    // بررسی خانه سیاه (قابل بازی)
+    bool isBlackSquare(const Position& pos) const {
+        return (pos.row + pos.col) % 2 == 1;
+    }
+    
+    // دریافت رنگ مهره
+    PieceType getPieceColor(PieceType piece) const {
+        if (piece == PieceType::BLACK_PIECE || piece == PieceType::BLACK_KING) {
+            return PieceType::BLACK_PIECE;
+        } else if (piece == PieceType::WHITE_PIECE || piece == PieceType::WHITE_KING) {
+            return PieceType::WHITE_PIECE;
+        }
+        return PieceType::EMPTY;
+    }
+    
+    // بررسی شاه بودن
+    bool isKing(PieceType piece) const {
+        return piece == PieceType::BLACK_KING || piece == PieceType::WHITE_KING;
+    }
+    
+    // دریافت تمام حرکات معتبر برای بازیکن: captureها اگر وجود دارند، وگرنه حرکات ساده
+    vector<Move> getAllValidMoves(PieceType player) const {
+        TraceSpan span("getAllValidMoves", "movegen");
+        vector<Move> capture_moves = getAllCaptureMoves(player);
+        if (!capture_moves.empty()) {
+            return capture_moves;
+        }
+        
+        vector<Move> moves;
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                PieceType piece = board[row][col];
+                if (getPieceColor(piece) == player) {
+                    vector<Move> piece_moves = getSimpleMoves(Position(row, col), piece, pieceDirections(piece));
+                    moves.insert(moves.end(), piece_moves.begin(), piece_moves.end());
+                }
+            }
+        }
+        return moves;
+    }
+    
+    // تمام captureهای مجاز؛ با قانون بیشترین capture فقط بلندترین زنجیره‌ها در یک گذر
+    vector<Move> getAllCaptureMoves(PieceType player) const {
+        TraceSpan span("getAllCaptureMoves", "movegen");
+        vector<Move> capture_moves;
+        int max_captures = 0;
+        
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                PieceType piece = board[row][col];
+                if (getPieceColor(piece) != player) {
+                    continue;
+                }
+                for (auto& move : getCaptureMoves(Position(row, col), piece, pieceDirections(piece))) {
+                    if constexpr (Rules::MAX_CAPTURE) {
+                        if (move.capture_count < max_captures) {
+                            continue;
+                        }
+                        if (move.capture_count > max_captures) {
+                            max_captures = move.capture_count;
+                            capture_moves.clear();
+                        }
+                    }
+                    capture_moves.push_back(move);
+                }
+            }
+        }
+        return capture_moves;
+    }
+    
+    // آیا بازیکن capture دارد؟ فقط پرش اول بررسی می‌شود، بدون ساختن زنجیره‌ها
+    bool hasCapture(PieceType player) const {
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                PieceType piece = board[row][col];
+                if (getPieceColor(piece) != player) {
+                    continue;
+                }
+                const bool flying = Rules::FLYING_KINGS && isKing(piece);
+                for (const auto& dir : pieceDirections(piece)) {
+                    Position jump_pos(row + dir.row, col + dir.col);
+                    while (flying && isValidPosition(jump_pos) &&
+                           board[jump_pos.row][jump_pos.col] == PieceType::EMPTY) {
+                        jump_pos = Position(jump_pos.row + dir.row, jump_pos.col + dir.col);
+                    }
+                    Position land_pos(jump_pos.row + dir.row, jump_pos.col + dir.col);
+                    if (!isValidPosition(land_pos) || board[land_pos.row][land_pos.col] != PieceType::EMPTY) {
+                        continue;
+                    }
+                    PieceType jumped_color = getPieceColor(board[jump_pos.row][jump_pos.col]);
+                    if (jumped_color != PieceType::EMPTY && jumped_color != player) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+    
+    // آیا بازیکن حرکتی دارد؟ capture با hasCapture، وگرنه اولین خانه خالی مجاور کافی است
+    bool hasAnyMove(PieceType player) const {
+        if (hasCapture(player)) {
+            return true;
+        }
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                PieceType piece = board[row][col];
+                if (getPieceColor(piece) != player) {
+                    continue;
+                }
+                for (const auto& dir : pieceDirections(piece)) {
+                    Position new_pos(row + dir.row, col + dir.col);
+                    if (isValidPosition(new_pos) && board[new_pos.row][new_pos.col] == PieceType::EMPTY) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+    
+    // جهت‌های حرکت یک مهره
+    const vector<Position>& pieceDirections(PieceType piece) const {
+        if (isKing(piece)) {
+            return KING_DIRECTIONS;
+        }
+        return piece == PieceType::BLACK_PIECE ? BLACK_DIRECTIONS : WHITE_DIRECTIONS;
+    }
+    
+    // دریافت حرکات برای یک مهره خاص
+    vector<Move> getMovesForPiece(const Position& pos, PieceType piece) const {
+        // بررسی حرکات capture
+        vector<Move> capture_moves = getCaptureMoves(pos, piece, pieceDirections(piece));
+        if (!capture_moves.empty()) {
+            return capture_moves;
+        }
+        
+        // حرکات ساده
+        return getSimpleMoves(pos, piece, pieceDirections(piece));
+    }
+    
+    // حرکات ساده
+    vector<Move> getSimpleMoves(const Position& pos, PieceType piece, 
+                               const vector<Position>& directions) const {
+        vector<Move> moves;
+        
+        for (const auto& dir : directions) {
+            Position new_pos(pos.row + dir.row, pos.col + dir.col);
+            
+            while (isValidPosition(new_pos) && board[new_pos.row][new_pos.col] == PieceType::EMPTY) {
+                Move move;
+                move.from = pos;
+                move.to.push_back(new_pos);
+                move.is_capture = false;
+                move.capture_count = 0;
+                move.becomes_king = shouldBecomeKing(new_pos, piece);
+                moves.push_back(move);
+                
+                // شاه پرنده تا اولین مانع ادامه می‌دهد
+                if (!Rules::FLYING_KINGS || !isKing(piece)) {
+                    break;
+                }
+                new_pos = Position(new_pos.row + dir.row, new_pos.col + dir.col);
+            }
+        }
+        
+        return moves;
+    }
+    
+    // حرکات capture
+    vector<Move> getCaptureMoves(const Position& pos, PieceType piece,
+                                const vector<Position>& directions) const {
+        // تعیین مهره‌های حریف
+        vector<PieceType> opponent_pieces;
+        if (getPieceColor(piece) == PieceType::BLACK_PIECE) {
+            opponent_pieces = {PieceType::WHITE_PIECE, PieceType::WHITE_KING};
+        } else {
+            opponent_pieces = {PieceType::BLACK_PIECE, PieceType::BLACK_KING};
+        }
+        
+        const bool flying = Rules::FLYING_KINGS && isKing(piece);
+        
+        // تابع بازگشتی برای جستجوی زنجیره‌ای
+        function<void(Position, vector<Position>, vector<Position>, vector<Move>&)> 
+        findCaptureChains = [&](Position current_pos, vector<Position> visited_captures,
+                               vector<Position> path, vector<Move>& result) {
+            for (const auto& dir : directions) {
+                Position jump_pos(current_pos.row + dir.row, current_pos.col + dir.col);
+                
+                // شاه پرنده: عبور از خانه‌های خالی تا اولین مهره
+                if (flying) {
+                    while (isValidPosition(jump_pos) &&
+                           board[jump_pos.row][jump_pos.col] == PieceType::EMPTY) {
+                        jump_pos = Position(jump_pos.row + dir.row, jump_pos.col + dir.col);
+                    }
+                }
+                Position land_pos(jump_pos.row + dir.row, jump_pos.col + dir.col);
+                
+                // بررسی امکان capture
+                if (isValidPosition(jump_pos) && isValidPosition(land_pos)) {
+                    PieceType jumped_piece = board[jump_pos.row][jump_pos.col];
+                    
+                    // بررسی اینکه مهره حریف باشد و قبلاً capture نشده باشد
+                    bool is_opponent = false;
+                    for (auto opp_piece : opponent_pieces) {
+                        if (jumped_piece == opp_piece) {
+                            is_opponent = true;
+                            break;
+                        }
+                    }
+                    
+                    bool already_captured = false;
+                    for (const auto& cap : visited_captures) {
+                        if (cap == jump_pos) {
+                            already_captured = true;
+                            break;
+                        }
+                    }
+                    
+                    if (!is_opponent || already_captured) {
+                        continue;
+                    }
+                    
+                    // خانه‌های فرود: یکی، یا برای شاه پرنده تمام خانه‌های خالی پشت مهره
+                    while (isValidPosition(land_pos) &&
+                           board[land_pos.row][land_pos.col] == PieceType::EMPTY) {
+                        
+                        // به‌روزرسانی مسیر
+                        vector<Position> new_visited = visited_captures;
+                        new_visited.push_back(jump_pos);
+                        vector<Position> new_path = path;
+                        new_path.push_back(land_pos);
+                        vector<Position> new_captured = visited_captures;
+                        new_captured.push_back(jump_pos);
+                        
+                        // جستجوی captureهای بیشتر (مگر اینکه شاه شدن حرکت را پایان دهد)
+                        vector<Move> further_chains;
+                        bool crowned = Rules::CROWNING_ENDS_MOVE && !isKing(piece) &&
+                                       shouldBecomeKing(land_pos, piece);
+                        if (!crowned) {
+                            findCaptureChains(land_pos, new_visited, new_path, further_chains);
+                        }
+                        
+                        if (!further_chains.empty()) {
+                            for (auto& chain : further_chains) {
+                                result.push_back(chain);
+                            }
+                        } else {
+                            Move move;
+                            move.from = pos;
+                            move.to = new_path;
+                            move.captured = new_captured;
+                            move.is_capture = true;
+                            move.capture_count = new_captured.size();
+                            move.becomes_king = shouldBecomeKing(land_pos, piece) || isKing(piece);
+                            result.push_back(move);
+                        }
+                        
+                        if (!flying) {
+                            break;
+                        }
+                        land_pos = Position(land_pos.row + dir.row, land_pos.col + dir.col);
+                    }
+                }
+            }
+        };
+        
+        vector<Move> chains;
+        findCaptureChains(pos, {}, {}, chains);
+        
+        return chains;
+    }
+    
+
+    // بررسی تبدیل به شاه
+    bool shouldBecomeKing(const Position& pos, PieceType piece) const {
+        if (piece == PieceType::BLACK_PIECE && pos.row == BOARD_SIZE - 1) {
+            return true;
+        } else if (piece == PieceType::WHITE_PIECE && pos.row == 0) {
+            return true;
+        }
+        return false;
+    }
+    
+    // اعمال حرکت
+    bool applyMove(const Move& move) {
+        if (!isValidPosition(move.from) || move.to.empty()) {
+            return false;
+        }
+        
+        // ذخیره مهره
+        PieceType piece = board[move.from.row][move.from.col];
+        
+        // capture و حرکت مهره ساده برگشت‌ناپذیرند و پنجره تکرار را می‌بندند
+        if (move.is_capture || !isKing(piece)) {
+            hash_stack.clear();
+            repetition_filter = 0;
+        } else {
+            hash_stack.push_back(hash);
+            repetition_filter |= filterBit(hash);
+        }
+        hash ^= pieceKey(move.from.row, move.from.col, piece);
+        for (const auto& cap_pos : move.captured) {
+            hash ^= pieceKey(cap_pos.row, cap_pos.col, board[cap_pos.row][cap_pos.col]);
+        }
+        
+        // به‌روزرسانی افزایشی NNUE پیش از تغییر صفحه
+        if (HAS_NNUE && nnue != nullptr) {
+            if (NNUENetwork::isPiece(piece)) {
+                nnue->removePiece(nnue_acc, move.from, piece);
+            }
+            for (const auto& cap_pos : move.captured) {
+                PieceType captured_piece = board[cap_pos.row][cap_pos.col];
+                if (NNUENetwork::isPiece(captured_piece)) {
+                    nnue->removePiece(nnue_acc, cap_pos, captured_piece);
+                }
+            }
+        }
+        
+        // حذف مهره از مبدأ
+        board[move.from.row][move.from.col] = PieceType::EMPTY;
+        
+        // حذف مهره‌های capture شده
+        for (const auto& cap_pos : move.captured) {
+            board[cap_pos.row][cap_pos.col] = PieceType::EMPTY;
+        }
+        
+        // قرار دادن مهره در مقصد نهایی
+        Position final_pos = move.to.back();
+        
+        // تبدیل به شاه اگر لازم باشد
+        if (move.becomes_king) {
+            if (getPieceColor(piece) == PieceType::BLACK_PIECE) {
+                board[final_pos.row][final_pos.col] = PieceType::BLACK_KING;
+            } else {
+                board[final_pos.row][final_pos.col] = PieceType::WHITE_KING;
+            }
+        } else {
+            board[final_pos.row][final_pos.col] = piece;
+        }
+        
+        if (HAS_NNUE && nnue != nullptr && NNUENetwork::isPiece(board[final_pos.row][final_pos.col])) {
+            nnue->addPiece(nnue_acc, final_pos, board[final_pos.row][final_pos.col]);
+        }
+        hash ^= pieceKey(final_pos.row, final_pos.col, board[final_pos.row][final_pos.col]);
+        
+        // ذخیره در تاریخچه
+        move_history.push_back(move);
+        
+        // تغییر نوبت
+        current_player = (current_player == PieceType::BLACK_PIECE) ? 
+                        PieceType::WHITE_PIECE : PieceType::BLACK_PIECE;
+        hash ^= ZOBRIST<SIZE>.side;
+        
+        // بررسی پایان بازی
+        checkGameOver();
+        
+        return true;
+    }
+    
+    // بررسی پایان بازی
+    void checkGameOver() {
+        int black_count = 0;
+        int white_count = 0;
+        
+        // شمارش مهره‌ها
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                PieceType piece = board[i][j];
+                if (piece == PieceType::BLACK_PIECE || piece == PieceType::BLACK_KING) {
+                    black_count++;
+                } else if (piece == PieceType::WHITE_PIECE || piece == PieceType::WHITE_KING) {
+                    white_count++;
+                }
+            }
+        }
+        
+        // اگر یکی از بازیکنان مهره‌ای نداشته باشد
+        if (black_count == 0) {
+            game_over = true;
+            winner = PieceType::WHITE_PIECE;
+            return;
+        }
+        
+        if (white_count == 0) {
+            game_over = true;
+            winner = PieceType::BLACK_PIECE;
+            return;
+        }
+        
+        // بررسی حرکت معتبر برای بازیکن فعلی (بدون ساختن فهرست حرکت‌ها)
+        if (!hasAnyMove(current_player)) {
+            game_over = true;
+            winner = (current_player == PieceType::BLACK_PIECE) ? 
+                    PieceType::WHITE_PIECE : PieceType::BLACK_PIECE;
+            return;
+        }
+        
+        // تکرار سه‌باره موقعیت: مساوی
+        if (repetitionCount() >= 2) {
+            game_over = true;
+            winner = PieceType::EMPTY;
+            return;
+        }
+        
+        // جلوگیری از حلقه بی‌نهایت
+        const size_t draw_plies = Rules::DRAW_PLIES;
+        if (move_history.size() >= draw_plies) {
+            int recent_captures = 0;
+            int start_idx = move_history.size() > draw_plies ? move_history.size() - draw_plies : 0;
+            
+            for (size_t i = start_idx; i < move_history.size(); i++) {
+                if (move_history[i].is_capture) {
+                    recent_captures++;
+                }
+            }
+            
+            if (recent_captures == 0) {
+                game_over = true;
+                winner = PieceType::EMPTY; // مساوی
+                return;
+            }
+        }
+        
+        game_over = false;
+    }
+    
+    void printColumnHeader() const {
+        cout << " ";
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            cout << " " << col;
+        }
+        cout << endl;
+    }
+    
+    // نمایش صفحه
+    void printBoard() const {
+        printColumnHeader();
+        
+        for (int row = BOARD_SIZE - 1; row >= 0; row--) {
+            cout << row << " ";
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                Position pos(row, col);
+                if (!isBlackSquare(pos)) {
+                    cout << "██";
+                } else {
+                    switch (board[row][col]) {
+                        case PieceType::EMPTY:
+                            cout << "  ";
+                            break;
+                        case PieceType::BLACK_PIECE:
+                            cout << "● ";
+                            break;
+                        case PieceType::WHITE_PIECE:
+                            cout << "○ ";
+                            break;
+                        case PieceType::BLACK_KING:
+                            cout << "♔ ";
+                            break;
+                        case PieceType::WHITE_KING:
+                            cout << "♕ ";
+                            break;
+                        default:
+                            cout << "  ";
+                    }
+                }
+            }
+            cout << " " << row << endl;
+        }
+        printColumnHeader();
+    }
+    
+    // دریافت کلید صفحه برای یادگیری
+    string getBoardKey() const {
+        string key;
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                key += to_string(static_cast<int>(board[i][j]));
+            }
+        }
+        return key;
+    }
+    
+    // آیا موقعیت فعلی (با همان نوبت) قبلاً در پنجره برگشت‌پذیر دیده شده است؟
+    // فیلتر bloom بیشتر موارد را در O(1) رد می‌کند.
+    bool isRepetition() const {
+        if (!(repetition_filter & filterBit(hash))) {
+            return false;
+        }
+        // فقط موقعیت‌هایی با همان نوبت (هر دو نیم‌حرکت)
+        for (size_t i = 2; i <= hash_stack.size(); i += 2) {
+            if (hash_stack[hash_stack.size() - i] == hash) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // تعداد دفعات قبلی وقوع موقعیت فعلی
+    int repetitionCount() const {
+        if (!(repetition_filter & filterBit(hash))) {
+            return 0;
+        }
+        int count = 0;
+        for (size_t i = 2; i <= hash_stack.size(); i += 2) {
+            if (hash_stack[hash_stack.size() - i] == hash) {
+                count++;
+            }
+        }
+        return count;
+    }
+    
+    uint64_t getHash() const { return hash; }
+    
+    // نیم‌حرکت‌های پیاپی بدون capture تا الان (تا سقف قانون مساوی)
+    int pliesSinceCapture() const {
+        int plies = 0;
+        for (auto it = move_history.rbegin(); it != move_history.rend() && !it->is_capture &&
+                                              plies < Rules::DRAW_PLIES; ++it) {
+            plies++;
+        }
+        return plies;
+    }
+    
+    // getterها
+    bool isGameOver() const { return game_over; }
+    PieceType getWinner() const { return winner; }
+    PieceType getCurrentPlayer() const { return current_player; }
+    const Board& getBoard() const { return board; }
+    const vector<Move>& getMoveHistory() const { return move_history; }
+    
+    // تنظیم صفحه از روی کلید getBoardKey (SIZE*SIZE رقم، ردیف به ردیف)
+    bool setFromBoardKey(const string& key, PieceType to_move) {
+        if (key.size() != BOARD_SIZE * BOARD_SIZE) {
+            return false;
+        }
+        for (char ch : key) {
+            if (ch < '0' || ch > '4') {
+                return false;
+            }
+        }
+        
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                board[i][j] = static_cast<PieceType>(key[i * BOARD_SIZE + j] - '0');
+            }
+        }
+        resetPosition(to_move);
+        return true;
+    }
+    
+    // شماره‌گذاری خانه‌های بازی (1..SQUARES)، ردیف به ردیف مانند PDN
+    static constexpr int SQUARES = SIZE * SIZE / 2;
+    
+    static Position squarePosition(int square) {
+        int index = square - 1;
+        int row = index / (SIZE / 2);
+        int col = 2 * (index % (SIZE / 2)) + (row % 2 == 0 ? 1 : 0);
+        return Position(row, col);
+    }
+    
+    static int squareNumber(int row, int col) {
+        return row * (SIZE / 2) + col / 2 + 1;
+    }
+    
+    // نمادگذاری فشرده متنی به سبک FEN در PDN: "B:W13,14,K16:B1,2,K5"
+    // (حرف اول: نوبت؛ سپس مهره‌های سفید و سیاه با پیشوند K برای شاه)
+    string toFen() const {
+        string fen = (current_player == PieceType::WHITE_PIECE) ? "W" : "B";
+        for (PieceType color : {PieceType::WHITE_PIECE, PieceType::BLACK_PIECE}) {
+            fen += (color == PieceType::WHITE_PIECE) ? ":W" : ":B";
+            bool first = true;
+            for (int square = 1; square <= SQUARES; square++) {
+                Position pos = squarePosition(square);
+                PieceType piece = board[pos.row][pos.col];
+                if (getPieceColor(piece) != color) continue;
+                if (!first) fen += ",";
+                if (isKing(piece)) fen += "K";
+                fen += to_string(square);
+                first = false;
+            }
+        }
+        return fen;
+    }
+    
+    // خواندن FEN (بازه‌هایی مانند 1-4 هم پذیرفته می‌شوند)؛ false برای ورودی نامعتبر
+    bool setFromFen(const string& fen) {
+        if (fen.empty() || (fen[0] != 'B' && fen[0] != 'W')) {
+            return false;
+        }
+        Board parsed;
+        for (auto& row : parsed) row.fill(PieceType::EMPTY);
+        
+        size_t pos = 1;
+        while (pos < fen.size()) {
+            if (fen[pos] != ':' || pos + 1 >= fen.size()) {
+                return false;
+            }
+            char color = fen[pos + 1];
+            if (color != 'W' && color != 'B') {
+                return false;
+            }
+            pos += 2;
+            while (pos < fen.size() && fen[pos] != ':') {
+                if (fen[pos] == ',') {
+                    pos++;
+                    continue;
+                }
+                bool king = fen[pos] == 'K';
+                if (king) pos++;
+                int first = 0;
+                size_t digits = pos;
+                while (pos < fen.size() && isdigit(static_cast<unsigned char>(fen[pos]))) {
+                    first = first * 10 + (fen[pos++] - '0');
+                }
+                int last = first;
+                if (pos < fen.size() && fen[pos] == '-') {
+                    last = 0;
+                    pos++;
+                    while (pos < fen.size() && isdigit(static_cast<unsigned char>(fen[pos]))) {
+                        last = last * 10 + (fen[pos++] - '0');
+                    }
+                }
+                if (pos == digits || first < 1 || last > SQUARES || first > last) {
+                    return false;
+                }
+                for (int square = first; square <= last; square++) {
+                    Position p = squarePosition(square);
+                    if (color == 'W') {
+                        parsed[p.row][p.col] = king ? PieceType::WHITE_KING : PieceType::WHITE_PIECE;
+                    } else {
+                        parsed[p.row][p.col] = king ? PieceType::BLACK_KING : PieceType::BLACK_PIECE;
+                    }
+                }
+            }
+        }
+        
+        board = parsed;
+        resetPosition(fen[0] == 'W' ? PieceType::WHITE_PIECE : PieceType::BLACK_PIECE);
+        return true;
+    }
+    
+    // قالب باینری فشرده (فقط 6x6): 3 بیت برای هر یک از 18 خانه و بیت 63 برای نوبت سفید
+    uint64_t pack() const {
+        static_assert(SQUARES * 3 < 63, "packed positions hold up to 20 squares");
+        uint64_t packed = (current_player == PieceType::WHITE_PIECE) ? (uint64_t(1) << 63) : 0;
+        for (int square = 1; square <= SQUARES; square++) {
+            Position pos = squarePosition(square);
+            packed |= uint64_t(static_cast<int>(board[pos.row][pos.col])) << (3 * (square - 1));
+        }
+        return packed;
+    }
+    
+    bool unpack(uint64_t packed) {
+        static_assert(SQUARES * 3 < 63, "packed positions hold up to 20 squares");
+        Board parsed;
+        for (auto& row : parsed) row.fill(PieceType::EMPTY);
+        for (int square = 1; square <= SQUARES; square++) {
+            int code = (packed >> (3 * (square - 1))) & 7;
+            if (code > static_cast<int>(PieceType::WHITE_KING)) {
+                return false;
+            }
+            Position pos = squarePosition(square);
+            parsed[pos.row][pos.col] = static_cast<PieceType>(code);
+        }
+        board = parsed;
+        resetPosition((packed >> 63) ? PieceType::WHITE_PIECE : PieceType::BLACK_PIECE);
+        return true;
+    }
+    
+    // اتصال شبکه NNUE و محاسبه کامل accumulator
+    void attachNNUE(const NNUENetwork* network) {
+        static_assert(HAS_NNUE, "NNUE features are defined for the 6x6 board only");
+        nnue = network;
+        if (nnue != nullptr) {
+            nnue->refresh(board, nnue_acc);
+        }
+    }
+    
+    const NNUENetwork* getNNUE() const { return nnue; }
+    const NNUEAccumulator& getNNUEAccumulator() const { return nnue_acc; }
+    
+    // ایجاد کپی
+    BasicCheckersGame copy() const {
+        return BasicCheckersGame(*this);
+    }
+};
+
+// بازی پروژه؛ عامل‌ها، ارزیاب‌های آموزش‌دیده و NNUE روی این نمونه کار می‌کنند
+using CheckersGame = BasicCheckersGame<Rules6x6>;
+using EnglishCheckersGame = BasicCheckersGame<RulesEnglish8x8>;
+using FlyingCheckersGame = BasicCheckersGame<RulesFlying8x8>;
+
+// ============================================================================
+// انتخاب‌گر مرحله‌ای حرکت (برای جستجو)
+// ============================================================================
+
+// جستجو حرکت‌ها را یکی‌یکی می‌کشد: ابتدا حرکت جدول، سپس captureها و فقط اگر
+// capture وجود ندارد حرکات ساده، مهره به مهره. گره‌ای که با حرکت اول برش
+// بخورد هزینه تولید کامل را نمی‌پردازد. حرکت جدول با خانه مبدأ و مقصد نهایی
+// (شماره خانه، 0 یعنی بدون حرکت) مشخص می‌شود.
+template<class Game>
+class MovePicker {
+public:
+    enum Stage { HASH_MOVE, CAPTURES, QUIETS, DONE };
+    
+private:
+    const Game& game;
+    PieceType player;
+    int hash_from;
+    int hash_to;
+    bool captures_exist;
+    bool hash_emitted = false;
+    Stage stage;
+    vector<Move> buffer;
+    size_t buffer_pos = 0;
+    int scan_square = 0;          // مهره بعدی برای تولید حرکات ساده
+    
+public:
+    MovePicker(const Game& g, int from_square = 0, int to_square = 0)
+        : game(g), player(g.getCurrentPlayer()), hash_from(from_square), hash_to(to_square),
+          captures_exist(g.hasCapture(player)) {
+        if (captures_exist) {
+            stage = CAPTURES;
+        } else {
+            stage = (hash_from > 0) ? HASH_MOVE : QUIETS;
+        }
+    }
+    
+    bool hasCaptures() const { return captures_exist; }
+    Stage getStage() const { return stage; }
+    
+    static int fromSquare(const Move& move) {
+        return Game::squareNumber(move.from.row, move.from.col);
+    }
+    
+    static int toSquare(const Move& move) {
+        return move.to.empty() ? 0 : Game::squareNumber(move.to.back().row, move.to.back().col);
+    }
+    
+    bool isHashMove(const Move& move) const {
+        return hash_from > 0 && fromSquare(move) == hash_from && toSquare(move) == hash_to;
+    }
+    
+    bool next(Move& move) {
+        while (true) {
+            switch (stage) {
+                case HASH_MOVE:
+                    stage = QUIETS;
+                    if (quietHashMove(move)) {
+                        hash_emitted = true;
+                        return true;
+                    }
+                    break;
+                    
+                case CAPTURES:
+                    if (buffer_pos == 0 && buffer.empty()) {
+                        buffer = game.getAllCaptureMoves(player);
+                        // حرکت جدول به ابتدای فهرست
+                        for (size_t i = 1; i < buffer.size(); i++) {
+                            if (isHashMove(buffer[i])) {
+                                rotate(buffer.begin(), buffer.begin() + i, buffer.begin() + i + 1);
+                                break;
+                            }
+                        }
+                    }
+                    if (buffer_pos < buffer.size()) {
+                        move = buffer[buffer_pos++];
+                        return true;
+                    }
+                    stage = DONE;
+                    break;
+                    
+                case QUIETS:
+                    while (buffer_pos < buffer.size()) {
+                        const Move& candidate = buffer[buffer_pos++];
+                        if (!(hash_emitted && isHashMove(candidate))) {
+                            move = candidate;
+                            return true;
+                        }
+                    }
+                    if (!refillQuiets()) {
+                        stage = DONE;
+                    }
+                    break;
+                    
+                case DONE:
+                    return false;
+            }
+        }
+    }
+    
+private:
+    // حرکات ساده مهره بعدی بازیکن
+    bool refillQuiets() {
+        TraceSpan span("MovePicker::refillQuiets", "movegen");
+        buffer.clear();
+        buffer_pos = 0;
+        while (scan_square < Game::SQUARES) {
+            Position pos = Game::squarePosition(++scan_square);
+            PieceType piece = game.getBoard()[pos.row][pos.col];
+            if (game.getPieceColor(piece) != player) {
+                continue;
+            }
+            buffer = game.getSimpleMoves(pos, piece, game.pieceDirections(piece));
+            if (!buffer.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // ساختن حرکت ساده جدول بدون تولید بقیه؛ در صورت نامعتبر بودن false
+    bool quietHashMove(Move& move) const {
+        if (hash_from <= 0 || hash_from > Game::SQUARES || hash_to <= 0 || hash_to > Game::SQUARES) {
+            return false;
+        }
+        Position from = Game::squarePosition(hash_from);
+        Position to = Game::squarePosition(hash_to);
+        const auto& board = game.getBoard();
+        PieceType piece = board[from.row][from.col];
+        if (game.getPieceColor(piece) != player || board[to.row][to.col] != PieceType::EMPTY) {
+            return false;
+        }
+        int d_row = to.row - from.row;
+        int d_col = to.col - from.col;
+        int distance = abs(d_row);
+        if (distance == 0 || abs(d_col) != distance) {
+            return false;
+        }
+        Position dir(d_row / distance, d_col / distance);
+        bool allowed = false;
+        for (const auto& d : game.pieceDirections(piece)) {
+            allowed = allowed || (d == dir);
+        }
+        if (!allowed || (distance > 1 && !(Game::RuleSet::FLYING_KINGS && game.isKing(piece)))) {
+            return false;
+        }
+        for (int step = 1; step < distance; step++) {
+            if (board[from.row + dir.row * step][from.col + dir.col * step] != PieceType::EMPTY) {
+                return false;
+            }
+        }
+        move = Move(from, to);
+        move.becomes_king = game.shouldBecomeKing(to, piece);
+        return true;
+    }
+};
+
+// ============================================================================
+// فایل موقعیت‌های فشرده و خواندن جریانی
+// ============================================================================
+
+// قالب فایل: "CKPS"، نسخه (uint32) و سپس موقعیت‌های pack() هر کدام 8 بایت little-endian
+const char POSITION_FILE_MAGIC[4] = {'C', 'K', 'P', 'S'};
+const uint32_t POSITION_FILE_VERSION = 1;
+const size_t POSITION_FILE_HEADER = 8;
+
+inline void storeLE64(unsigned char* out, uint64_t value) {
+    for (int b = 0; b < 8; b++) {
+        out[b] = static_cast<unsigned char>(value >> (8 * b));
+    }
+}
+
+inline uint64_t loadLE64(const unsigned char* in) {
+    uint64_t value = 0;
+    for (int b = 7; b >= 0; b--) {
+        value = (value << 8) | in[b];
+    }
+    return value;
+}
+
+// نوشتن بافرشده موقعیت‌های فشرده
+class PositionWriter {
+private:
+    static const size_t BUFFER_POSITIONS = 8192;
+    
+    ofstream file;
+    vector<unsigned char> buffer;
+    size_t buffered = 0;
+    size_t written = 0;
+    
+public:
+    explicit PositionWriter(const string& filename)
+        : file(filename, ios::binary), buffer(BUFFER_POSITIONS * 8) {
+        unsigned char header[POSITION_FILE_HEADER];
+        memcpy(header, POSITION_FILE_MAGIC, 4);
+        for (int b = 0; b < 4; b++) {
+            header[4 + b] = static_cast<unsigned char>(POSITION_FILE_VERSION >> (8 * b));
+        }
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+    
+    ~PositionWriter() {
+        flush();
+    }
+    
+    bool isOpen() const { return file.good(); }
+    size_t count() const { return written + buffered; }
+    
+    void write(uint64_t packed) {
+        storeLE64(&buffer[buffered * 8], packed);
+        if (++buffered == BUFFER_POSITIONS) {
+            flush();
+        }
+    }
+    
+    void flush() {
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffered * 8);
+        file.flush();
+        written += buffered;
+        buffered = 0;
+    }
+};
+
+// خواندن جریانی: نگاشت حافظه در صورت امکان، وگرنه قطعه‌های ثابت؛
+// هیچ تخصیصی به ازای هر موقعیت انجام نمی‌شود
+class PositionReader {
+private:
+    static constexpr size_t CHUNK_POSITIONS = 8192;
+    
+    string filename;
+    bool valid = false;
+    size_t positions = 0;
+#ifdef CHECKERS_HAVE_MMAP
+    int fd = -1;
+    const unsigned char* mapped = nullptr;
+    size_t mapped_bytes = 0;
+#endif
+    
+public:
+    explicit PositionReader(const string& name) : filename(name) {
+        ifstream file(filename, ios::binary | ios::ate);
+        if (!file) {
+            return;
+        }
+        size_t bytes = static_cast<size_t>(file.tellg());
+        unsigned char header[POSITION_FILE_HEADER];
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!file || bytes < POSITION_FILE_HEADER || memcmp(header, POSITION_FILE_MAGIC, 4) != 0 ||
+            header[4] != POSITION_FILE_VERSION) {
+            return;
+        }
+        positions = (bytes - POSITION_FILE_HEADER) / 8;
+        valid = true;
+        
+#ifdef CHECKERS_HAVE_MMAP
+        fd = open(filename.c_str(), O_RDONLY);
+        if (fd >= 0 && bytes > 0) {
+            void* region = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (region != MAP_FAILED) {
+                madvise(region, bytes, MADV_SEQUENTIAL);
+                mapped = static_cast<const unsigned char*>(region);
+                mapped_bytes = bytes;
+            }
+        }
+#endif
+    }
+    
+    ~PositionReader() {
+#ifdef CHECKERS_HAVE_MMAP
+        if (mapped != nullptr) {
+            munmap(const_cast<unsigned char*>(mapped), mapped_bytes);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+    
+    PositionReader(const PositionReader&) = delete;
+    PositionReader& operator=(const PositionReader&) = delete;
+    
+    bool isOpen() const { return valid; }
+    size_t size() const { return positions; }
+    bool isMapped() const {
+#ifdef CHECKERS_HAVE_MMAP
+        return mapped != nullptr;
+#else
+        return false;
+#endif
+    }
+    
+    // on_position(uint64_t packed) برای هر موقعیت؛ خروجی: تعداد خوانده‌شده
+    template<class Callback>
+    size_t forEach(Callback&& on_position) const {
+        if (!valid) {
+            return 0;
+        }
+#ifdef CHECKERS_HAVE_MMAP
+        if (mapped != nullptr) {
+            const unsigned char* data = mapped + POSITION_FILE_HEADER;
+            for (size_t i = 0; i < positions; i++) {
+                on_position(loadLE64(data + 8 * i));
+            }
+            return positions;
+        }
+#endif
+        ifstream file(filename, ios::binary);
+        file.seekg(POSITION_FILE_HEADER);
+        vector<unsigned char> chunk(CHUNK_POSITIONS * 8);
+        size_t done = 0;
+        while (done < positions) {
+            size_t count = min(CHUNK_POSITIONS, positions - done);
+            file.read(reinterpret_cast<char*>(chunk.data()), count * 8);
+            if (!file) {
+                break;
+            }
+            for (size_t i = 0; i < count; i++) {
+                on_position(loadLE64(&chunk[i * 8]));
+            }
+            done += count;
+        }
+        return done;
+    }
+    
+    // فایل متنی: یک FEN در هر خط (خطوط خالی و # نادیده گرفته می‌شوند)
+    template<class Callback>
+    static size_t forEachFenLine(const string& name, Callback&& on_line) {
+        ifstream file(name);
+        string line;
+        size_t count = 0;
+        while (getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            on_line(line);
+            count++;
+        }
+        return count;
+    }
+    
+    // همه موقعیت‌های یک فایل باینری یا FEN؛ invalid: خطوط FEN نامعتبر
+    static vector<uint64_t> readAll(const string& name, size_t& invalid) {
+        vector<uint64_t> positions;
+        PositionReader reader(name);
+        if (reader.isOpen()) {
+            positions.reserve(reader.size());
+            reader.forEach([&](uint64_t packed) { positions.push_back(packed); });
+        } else {
+            CheckersGame game;
+            forEachFenLine(name, [&](const string& line) {
+                if (game.setFromFen(line)) {
+                    positions.push_back(game.pack());
+                } else {
+                    invalid++;
+                }
+            });
+        }
+        return positions;
+    }
+};
+
+// ============================================================================
+// کلاس پایه عامل
+// ============================================================================
+
+// توقف همکارانه: کپی‌ها یک پرچم مشترک دارند
+class StopToken {
+private:
+    shared_ptr<atomic<bool>> flag;
+    
+public:
+    StopToken() : flag(make_shared<atomic<bool>>(false)) {}
+    
+    void requestStop() const { flag->store(true); }
+    bool stopRequested() const { return flag->load(memory_order_relaxed); }
+    const atomic<bool>* get() const { return flag.get(); }
+};
+
+class CheckersAgent {
+protected:
+    PieceType player;
+    string name;
+    
+public:
+    CheckersAgent(PieceType p, string n = "Base Agent") : player(p), name(n) {}
+    virtual ~CheckersAgent() = default;
+    
+    virtual Move getMove(const CheckersGame& game) = 0;
+    
+    // جستجوی قابل توقف؛ عامل‌های سریع توقف را نادیده می‌گیرند
+    virtual Move getMove(const CheckersGame& game, const StopToken& stop) {
+        (void)stop;
+        return getMove(game);
+    }
+    
+    // جستجو در نخ جداگانه روی کپی موقعیت؛ با stop.requestStop() زودتر تمام می‌شود
+    future<Move> getMoveAsync(const CheckersGame& game, StopToken stop = StopToken()) {
+        CheckersGame position = game.copy();
+        return async(launch::async, [this, position, stop]() {
+            return getMove(position, stop);
+        });
+    }
+    
+    // جستجو در زمان حریف (game: موقعیت پس از حرکت خود عامل)؛ پیش‌فرض: هیچ
+    virtual void startPondering(const CheckersGame& game) { (void)game; }
+    virtual void stopPondering() {}
+    
+    string getName() const { return name; }
+    PieceType getPlayer() const { return player; }
+};
+
+// ============================================================================
+// عامل تصادفی
+// ============================================================================
+
+class RandomAgent : public CheckersAgent {
+private:
+    Xoshiro256 rng;
+    
+public:
+    RandomAgent(PieceType p, uint64_t seed = 1) : CheckersAgent(p, "Random Agent"), rng(seed) {}
+    
+    void reseed(uint64_t seed) { rng.reseed(seed); }
+    
+    Move getMove(const CheckersGame& game) override {
+        vector<Move> moves = game.getAllValidMoves(player);
+        
+        if (moves.empty()) {
+            return Move();
+        }
+        
+        return moves[rng.below(moves.size())];
+    }
+};
+
+// ============================================================================
+// عامل حریصانه
+// ============================================================================
+
+class GreedyAgent : public CheckersAgent {
+public:
+    GreedyAgent(PieceType p) : CheckersAgent(p, "Greedy Agent") {}
+    
+    Move getMove(const CheckersGame& game) override {
+        vector<Move> moves = game.getAllValidMoves(player);
+        
+        if (moves.empty()) {
+            return Move();
+        }
+        
+        // پیدا کردن حرکت با بیشترین capture
+        Move best_move = moves[0];
+        for (const auto& move : moves) {
+            if (move.capture_count > best_move.capture_count) {
+                best_move = move;
+            }
+        }
+        
+        return best_move;
+    }
+};
+
+// ============================================================================
+// ارزیاب خطی قابل آموزش (TD(λ))
+// ============================================================================
+
+class LinearEvaluator {
+public:
+    // ویژگی‌های کلی؛ پس از آن‌ها یک وزن PST برای هر خانه قابل بازی می‌آید
+    enum Feature {
+        F_MEN = 0,       // تفاضل مهره‌های معمولی
+        F_KINGS,         // تفاضل شاه‌ها
+        F_MOBILITY,      // تفاضل حرکات ساده ممکن
+        F_BACK_RANK,     // مهره‌های باقی‌مانده در ردیف خانگی
+        F_CENTER,        // کنترل مرکز
+        F_ADVANCE,       // میزان پیشروی مهره‌های معمولی
+        F_EDGE,          // مهره‌های کنار دیوار
+        F_THREATS,       // مهره‌هایی که امکان capture دارند
+        F_TEMPO,         // نوبت حرکت
+        NUM_GENERAL_FEATURES
+    };
+
+    static const int NUM_SQUARES = 18;
+    static const int NUM_FEATURES = NUM_GENERAL_FEATURES + NUM_SQUARES;
+    using Features = array<double, NUM_FEATURES>;
+
+    // مقیاس تبدیل امتیاز خطی به مقدار (-1..1) برای TD
+    static constexpr double VALUE_SCALE = 0.25;
+
+    LinearEvaluator() { resetWeights(); }
+
+    // وزن‌های اولیه معادل evaluateBasic
+    void resetWeights() {
+        weights.fill(0.0);
+        weights[F_MEN] = 1.0;
+        weights[F_KINGS] = 3.0;
+    }
+
+    // شماره خانه قابل بازی (0..17) از دید بازیکن
+    static int squareIndex(int row, int col, PieceType player) {
+        if (player == PieceType::WHITE_PIECE) {
+            row = 5 - row;
+            col = 5 - col;
+        }
+        return row * 3 + col / 2;
+    }
+
+    // استخراج ویژگی‌ها از دید player
+    Features extractFeatures(const CheckersGame& game, PieceType player) const {
+        Features f;
+        f.fill(0.0);
+        const auto& board = game.getBoard();
+
+        for (int i = 0; i < 6; i++) {
+            for (int j = 0; j < 6; j++) {
+                if (!game.isBlackSquare({i, j})) continue;
+
+                PieceType piece = board[i][j];
+                PieceType color = game.getPieceColor(piece);
+                if (color == PieceType::EMPTY) continue;
+
+                double sign = (color == player) ? 1.0 : -1.0;
+                bool king = game.isKing(piece);
+                // ردیف نسبی: 0 ردیف خانگی، 5 ردیف تبدیل به شاه
+                int rel_row = (color == PieceType::BLACK_PIECE) ? i : 5 - i;
+
+                if (king) {
+                    f[F_KINGS] += sign;
+                } else {
+                    f[F_MEN] += sign;
+                    f[F_ADVANCE] += sign * rel_row / 5.0;
+                    if (rel_row == 0) f[F_BACK_RANK] += sign;
+                    f[NUM_GENERAL_FEATURES + squareIndex(i, j, color)] += sign;
+                }
+
+                if (i >= 2 && i <= 3 && j >= 1 && j <= 4) f[F_CENTER] += sign;
+                if (j == 0 || j == 5) f[F_EDGE] += sign;
+
+                // حرکات ساده و تهدیدهای capture این مهره
+                bool has_threat = false;
+                for (const auto& dir : KING_DIRECTIONS) {
+                    int forward = (color == PieceType::BLACK_PIECE) ? 1 : -1;
+                    if (!king && dir.row != forward) continue;
+
+                    int r1 = i + dir.row, c1 = j + dir.col;
+                    if (r1 < 0 || r1 >= 6 || c1 < 0 || c1 >= 6) continue;
+
+                    PieceType target = board[r1][c1];
+                    if (target == PieceType::EMPTY) {
+                        f[F_MOBILITY] += sign * 0.25;
+                        continue;
+                    }
+
+                    int r2 = r1 + dir.row, c2 = c1 + dir.col;
+                    if (r2 >= 0 && r2 < 6 && c2 >= 0 && c2 < 6 &&
+                        board[r2][c2] == PieceType::EMPTY &&
+                        game.getPieceColor(target) != color) {
+                        has_threat = true;
+                    }
+                }
+                if (has_threat) f[F_THREATS] += sign;
+            }
+        }
+
+        f[F_TEMPO] = (game.getCurrentPlayer() == player) ? 1.0 : -1.0;
+        return f;
+    }
+
+    // امتیاز خطی (هم‌مقیاس با evaluateBasic)
+    double score(const Features& f) const {
+        double s = 0.0;
+        for (int k = 0; k < NUM_FEATURES; k++) {
+            s += weights[k] * f[k];
+        }
+        return s;
+    }
+
+    double evaluate(const CheckersGame& game, PieceType player) const {
+        return score(extractFeatures(game, player));
+    }
+
+    // مقدار در بازه (-1, 1) برای آموزش
+    double value(const Features& f) const {
+        return tanh(VALUE_SCALE * score(f));
+    }
+
+    array<double, NUM_FEATURES>& getWeights() { return weights; }
+    const array<double, NUM_FEATURES>& getWeights() const { return weights; }
+
+    // ذخیره وزن‌ها (متنی)
+    bool saveWeights(const string& filename) const {
+        ofstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.precision(17);
+        file << NUM_FEATURES << "\n";
+        for (double w : weights) {
+            file << w << "\n";
+        }
+        return true;
+    }
+
+    // بارگذاری وزن‌ها؛ در صورت ناسازگاری فایل، وزن‌های پیش‌فرض حفظ می‌شوند
+    bool loadWeights(const string& filename) {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+        int count = 0;
+        file >> count;
+        if (count != NUM_FEATURES) {
+            return false;
+        }
+        array<double, NUM_FEATURES> loaded;
+        for (int k = 0; k < NUM_FEATURES; k++) {
+            if (!(file >> loaded[k])) {
+                return false;
+            }
+        }
+        weights = loaded;
+        return true;
+    }
+
+private:
+    array<double, NUM_FEATURES> weights;
+};
+
+// ============================================================================
+// پارامترهای ارزیاب‌های دستی (قابل تنظیم با تیونر Texel)
+// ============================================================================
+
+// ضرایب evaluateBasic/Advanced/Positional. پیش‌فرض‌ها همان ثابت‌های قبلی‌اند؛
+// جدول دستی 6x6 فقط روی خانه‌های روشن (بازی‌نشدنی) مقدار داشت، پس ارزش مؤثر
+// هر 18 خانه بازی در پیش‌فرض صفر است.
+struct EvalParams {
+    static const int SQUARES = 18;                 // جدول موقعیت فقط برای 6x6
+    enum Index { MAN = 0, KING, ADVANCEMENT, CENTER_BONUS, EDGE_PENALTY, FIRST_SQUARE };
+    static const int COUNT = FIRST_SQUARE + SQUARES;
+    
+    array<double, COUNT> values;
+    array<array<double, 6>, 6> table{};            // values[FIRST_SQUARE..] روی صفحه 6x6
+    
+    EvalParams() {
+        values.fill(0.0);
+        values[MAN] = 1.0;
+        values[KING] = 3.0;
+        values[ADVANCEMENT] = 0.05;
+        values[CENTER_BONUS] = 0.1;
+        values[EDGE_PENALTY] = 0.05;
+        rebuildTable();
+    }
+    
+    double man() const { return values[MAN]; }
+    double king() const { return values[KING]; }
+    double advancement() const { return values[ADVANCEMENT]; }
+    double centerBonus() const { return values[CENTER_BONUS]; }
+    double edgePenalty() const { return values[EDGE_PENALTY]; }
+    
+    void rebuildTable() {
+        for (auto& row : table) row.fill(0.0);
+        for (int k = 0; k < SQUARES; k++) {
+            Position pos = CheckersGame::squarePosition(k + 1);
+            table[pos.row][pos.col] = values[FIRST_SQUARE + k];
+        }
+    }
+    
+    static string name(int index) {
+        static const char* names[] = {"man", "king", "advancement", "center_bonus", "edge_penalty"};
+        return index < FIRST_SQUARE ? names[index] : "square" + to_string(index - FIRST_SQUARE + 1);
+    }
+    
+    // فایل متنی: یک «نام مقدار» در هر خط؛ نام‌های غایب مقدار فعلی را حفظ می‌کنند
+    bool save(const string& filename) const {
+        ofstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.precision(17);
+        for (int k = 0; k < COUNT; k++) {
+            file << name(k) << " " << values[k] << "\n";
+        }
+        return file.good();
+    }
+    
+    bool load(const string& filename) {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+        array<double, COUNT> loaded = values;
+        string key;
+        double value;
+        while (file >> key >> value) {
+            int k = 0;
+            while (k < COUNT && name(k) != key) k++;
+            if (k == COUNT) {
+                return false;
+            }
+            loaded[k] = value;
+        }
+        if (!file.eof()) {
+            return false;
+        }
+        values = loaded;
+        rebuildTable();
+        return true;
+    }
+};
+
+// پارامترهای فعال؛ یک بار هنگام شروع از checkers_eval.params خوانده می‌شوند
+const EvalParams& evalParams() {
+    static const EvalParams params = []() {
+        EvalParams p;
+        p.load("checkers_eval.params");
+        return p;
+    }();
+    return params;
+}
+
+// ============================================================================
+// آمار جستجو
+// ============================================================================
+
+struct SearchStats {
+    static const int CUTOFF_BUCKETS = 8;   // آخرین خانه: اندیس 7 و بالاتر
+
+    long long nodes = 0;
+    long long leaf_evals = 0;
+    long long cutoffs = 0;
+    long long capture_moves = 0;          // حرکات capture جستجو شده
+    long long capture_chains = 0;         // captureهای زنجیره‌ای (بیش از یک مهره)
+    long long cache_probes = 0;
+    long long cache_hits = 0;
+    long long repetitions = 0;            // گره‌هایی که به‌خاطر تکرار مساوی شدند
+    long long lmr_reductions = 0;         // حرکات دیرهنگام با عمق کاهش‌یافته
+    long long lmr_researches = 0;         // جستجوی دوباره پس از fail-high
+    long long futility_prunes = 0;
+    long long probcut_cuts = 0;
+    double elapsed_ms = 0.0;
+    int depth = 0;
+    HardwareCounterValues hardware;       // فقط با setHardwareCounters(true)
+    vector<long long> nodes_per_ply;      // تعداد گره در هر لایه از ریشه
+    array<long long, CUTOFF_BUCKETS> cutoff_index{};   // اندیس حرکتی که cutoff داده
+
+    void reset(int search_depth) {
+        *this = SearchStats();
+        depth = search_depth;
+        nodes_per_ply.assign(search_depth + 1, 0);
+    }
+
+    void countNode(int ply) {
+        nodes++;
+        if (ply >= 0 && ply < static_cast<int>(nodes_per_ply.size())) {
+            nodes_per_ply[ply]++;
+        }
+    }
+
+    void countMove(const Move& move) {
+        if (move.is_capture) {
+            capture_moves++;
+            if (move.capture_count > 1) capture_chains++;
+        }
+    }
+
+    void countCutoff(size_t move_index) {
+        cutoffs++;
+        cutoff_index[min<size_t>(move_index, CUTOFF_BUCKETS - 1)]++;
+    }
+
+    double nps() const {
+        return elapsed_ms > 0 ? nodes * 1000.0 / elapsed_ms : 0.0;
+    }
+
+    double firstMoveCutoffRate() const {
+        return cutoffs > 0 ? static_cast<double>(cutoff_index[0]) / cutoffs : 0.0;
+    }
+
+    double cacheHitRate() const {
+        return cache_probes > 0 ? static_cast<double>(cache_hits) / cache_probes : 0.0;
+    }
+
+    // ضریب انشعاب مؤثر هر لایه: گره‌های لایه بعد / گره‌های این لایه
+    vector<double> branchingFactors() const {
+        vector<double> factors;
+        for (size_t p = 0; p + 1 < nodes_per_ply.size(); p++) {
+            if (nodes_per_ply[p] == 0 || nodes_per_ply[p + 1] == 0) break;
+            factors.push_back(static_cast<double>(nodes_per_ply[p + 1]) / nodes_per_ply[p]);
+        }
+        return factors;
+    }
+
+    // یک خط JSON برای لاگ ساخت‌یافته
+    string toLogLine(const string& agent_name) const {
+        ostringstream line;
+        line << "{\"event\":\"search\",\"agent\":\"" << agent_name << "\",\"depth\":" << depth
+             << ",\"nodes\":" << nodes << ",\"leaf_evals\":" << leaf_evals
+             << ",\"time_ms\":" << elapsed_ms << ",\"nps\":" << static_cast<long long>(nps())
+             << ",\"ebf\":[";
+        vector<double> factors = branchingFactors();
+        for (size_t i = 0; i < factors.size(); i++) {
+            line << (i ? "," : "") << factors[i];
+        }
+        line << "],\"cutoffs\":" << cutoffs << ",\"first_move_cutoff_rate\":" << firstMoveCutoffRate()
+             << ",\"cutoff_index\":[";
+        for (int i = 0; i < CUTOFF_BUCKETS; i++) {
+            line << (i ? "," : "") << cutoff_index[i];
+        }
+        line << "],\"capture_moves\":" << capture_moves << ",\"capture_chains\":" << capture_chains
+             << ",\"cache_probes\":" << cache_probes << ",\"cache_hits\":" << cache_hits
+             << ",\"cache_hit_rate\":" << cacheHitRate()
+             << ",\"repetitions\":" << repetitions
+             << ",\"lmr_reductions\":" << lmr_reductions << ",\"lmr_researches\":" << lmr_researches
+             << ",\"futility_prunes\":" << futility_prunes << ",\"probcut_cuts\":" << probcut_cuts;
+        if (hardware.valid) {
+            line << ",\"cycles\":" << hardware.cycles << ",\"instructions\":" << hardware.instructions
+                 << ",\"ipc\":" << hardware.ipc() << ",\"cache_misses\":" << hardware.cache_misses
+                 << ",\"branch_misses\":" << hardware.branch_misses;
+        }
+        line << "}";
+        return line.str();
+    }
+};
+
+// ============================================================================
+// جدول جابجایی (بین جستجوها و در حالت ponder گرم می‌ماند)
+// ============================================================================
+
+struct TTEntry {
+    uint64_t key = 0;
+    double value = 0.0;          // از دید بازیکن عامل
+    int8_t depth = -1;
+    uint8_t bound = 0;
+    uint8_t best_from = 0;       // بهترین حرکت: خانه مبدأ و مقصد نهایی (0: ندارد)
+    uint8_t best_to = 0;
+    uint8_t generation = 0;
+};
+
+class TranspositionTable {
+public:
+    enum Bound : uint8_t { NONE = 0, EXACT = 1, LOWER = 2, UPPER = 3 };
+    
+private:
+    vector<TTEntry> entries;
+    uint64_t mask = 0;
+    uint8_t generation = 0;
+    
+public:
+    explicit TranspositionTable(int size_log2 = 16) { resize(size_log2); }
+    
+    void resize(int size_log2) {
+        entries.assign(size_t(1) << size_log2, TTEntry());
+        mask = (uint64_t(1) << size_log2) - 1;
+    }
+    
+    void clear() {
+        fill(entries.begin(), entries.end(), TTEntry());
+    }
+    
+    // جستجوی جدید: مدخل‌های قبلی قابل جایگزینی می‌شوند
+    void newSearch() { generation++; }
+    
+    const TTEntry* probe(uint64_t key) const {
+        const TTEntry& entry = entries[key & mask];
+        return (entry.bound != NONE && entry.key == key) ? &entry : nullptr;
+    }
+    
+    // جایگزینی: مدخل عمیق‌تر همین جستجو حفظ می‌شود
+    void store(uint64_t key, int depth, double value, Bound bound, int best_from, int best_to) {
+        TTEntry& entry = entries[key & mask];
+        if (entry.key != key && entry.bound != NONE && entry.generation == generation &&
+            entry.depth > depth) {
+            return;
+        }
+        entry.key = key;
+        entry.value = value;
+        entry.depth = static_cast<int8_t>(depth);
+        entry.bound = bound;
+        entry.best_from = static_cast<uint8_t>(best_from);
+        entry.best_to = static_cast<uint8_t>(best_to);
+        entry.generation = generation;
+    }
+    
+    size_t size() const { return entries.size(); }
+};
+
+// ============================================================================
+// موقعیت‌های حل‌شده (خروجی حل‌کننده df-pn)
+// ============================================================================
+
+// مقدار نظری از دید بازیکن در نوبت
+enum class SolvedValue : int8_t { LOSS = -1, DRAW = 0, WIN = 1, UNKNOWN = 2 };
+
+struct SolvedEntry {
+    SolvedValue value = SolvedValue::UNKNOWN;
+    uint8_t best_from = 0;           // حرکت بُرد یا مساوی (0: ثبت نشده)
+    uint8_t best_to = 0;
+};
+
+using SolvedTable = unordered_map<uint64_t, SolvedEntry>;
+
+// کلید موقعیت حل‌شده: pack() به‌علاوه شمارنده نیم‌حرکت‌های بدون capture در
+// بیت‌های 54 تا 58، چون قانون مساوی 6x6 به آن وابسته است
+const int SOLVED_COUNTER_SHIFT = 54;
+
+inline uint64_t solvedKey(uint64_t packed, int plies_since_capture) {
+    return packed | (uint64_t(plies_since_capture) << SOLVED_COUNTER_SHIFT);
+}
+
+inline uint64_t solvedKey(const CheckersGame& game) {
+    return solvedKey(game.pack(), game.pliesSinceCapture());
+}
+
+// قالب فایل: "CKSV"، نسخه و سپس برای هر موقعیت دو کلمه 8 بایتی: کلید و
+// (مقدار+1) | مبدأ << 8 | مقصد << 16
+const char SOLVED_FILE_MAGIC[4] = {'C', 'K', 'S', 'V'};
+const uint32_t SOLVED_FILE_VERSION = 1;
+
+bool saveSolvedTable(const string& filename, const SolvedTable& table) {
+    ofstream file(filename, ios::binary);
+    if (!file) {
+        return false;
+    }
+    unsigned char header[8] = {'C', 'K', 'S', 'V', static_cast<unsigned char>(SOLVED_FILE_VERSION), 0, 0, 0};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    // ترتیب ثابت تا فایل‌ها قابل مقایسه باشند
+    vector<pair<uint64_t, SolvedEntry>> sorted(table.begin(), table.end());
+    sort(sorted.begin(), sorted.end(),
+         [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& [key, entry] : sorted) {
+        unsigned char record[16];
+        storeLE64(record, key);
+        storeLE64(record + 8, uint64_t(static_cast<int>(entry.value) + 1) | (uint64_t(entry.best_from) << 8) |
+                              (uint64_t(entry.best_to) << 16));
+        file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+    return static_cast<bool>(file);
+}
+
+// بدون فایل معتبر nullptr؛ مقادیر جدید روی جدول موجود نوشته می‌شوند
+shared_ptr<SolvedTable> loadSolvedTable(const string& filename) {
+    ifstream file(filename, ios::binary);
+    unsigned char header[8];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        memcmp(header, SOLVED_FILE_MAGIC, 4) != 0 || header[4] != SOLVED_FILE_VERSION) {
+        return nullptr;
+    }
+    auto table = make_shared<SolvedTable>();
+    unsigned char record[16];
+    while (file.read(reinterpret_cast<char*>(record), sizeof(record))) {
+        uint64_t info = loadLE64(record + 8);
+        SolvedEntry entry;
+        entry.value = static_cast<SolvedValue>(static_cast<int>(info & 0xFF) - 1);
+        entry.best_from = static_cast<uint8_t>(info >> 8);
+        entry.best_to = static_cast<uint8_t>(info >> 16);
+        (*table)[loadLE64(record)] = entry;
+    }
+    return table;
+}
+
+// فایل جدول پیش‌فرض عامل‌ها؛ فقط با درخواست صریح (--solved FILE یا متغیر محیطی
+// CHECKERS_SOLVED). خالی: بدون جدول، عامل‌ها همیشه جستجو می‌کنند
+string& solvedTableFile() {
+    static string file = getenv("CHECKERS_SOLVED") ? getenv("CHECKERS_SOLVED") : "";
+    return file;
+}
+
+// جدول پیش‌فرض در اولین ساخت عامل یک بار خوانده و بین عامل‌ها به اشتراک گذاشته می‌شود
+shared_ptr<const SolvedTable> defaultSolvedTable() {
+    static const shared_ptr<const SolvedTable> table = []() -> shared_ptr<const SolvedTable> {
+        const string& file = solvedTableFile();
+        if (file.empty()) {
+            return nullptr;
+        }
+        shared_ptr<const SolvedTable> loaded = loadSolvedTable(file);
+        if (!loaded) {
+            cerr << "cannot read solved table " << file << endl;
+        }
+        return loaded;
+    }();
+    return table;
+}
+
+// جستجوی انتخابی؛ هر ویژگی جداگانه روشن می‌شود تا بتوان آن را A/B آزمود
+struct SearchOptions {
+    // کاهش عمق حرکات ساده‌ای که دیر در ترتیب می‌آیند؛ جستجوی دوباره پس از fail-high
+    bool lmr = false;
+    int lmr_min_depth = 3;
+    int lmr_min_index = 3;
+    
+    // هرس futility نزدیک برگ‌ها با حاشیه مادی (مهره به ازای هر لایه)
+    bool futility = false;
+    int futility_max_depth = 2;
+    double futility_margin = 1.0;
+    
+    // ProbCut: جستجوی کم‌عمق چند حرکت اول با پنجره جابجاشده به اندازه margin
+    bool probcut = false;
+    int probcut_min_depth = 5;
+    int probcut_reduction = 3;
+    double probcut_margin = 1.0;
+    int probcut_moves = 3;
+    
+    string suffix() const {
+        return string(lmr ? "+lmr" : "") + (futility ? "+futility" : "") + (probcut ? "+probcut" : "");
+    }
+};
+
+// محدودیت‌های یک جستجوی عمیق‌شونده (0 یعنی بدون محدودیت)
+struct SearchLimits {
+    int depth = 0;                          // 0: عمق پیش‌فرض عامل
+    long long nodes = 0;
+    int movetime_ms = 0;
+    const atomic<bool>* stop = nullptr;     // توقف از نخ دیگر
+};
+
+// نتیجه هر تکرار کامل عمیق‌شونده
+struct SearchInfo {
+    int depth = 0;
+    double score = 0.0;                     // از دید بازیکن در نوبت
+    long long nodes = 0;
+    double elapsed_ms = 0.0;
+    vector<Move> pv;
+};
+
+// تحلیل چندخطی: یک خط برای هر حرکت برتر ریشه
+struct AnalysisLine {
+    Move move;
+    double score = 0.0;                     // از دید بازیکن در نوبت
+    vector<Move> pv;
+};
+
+struct AnalysisResult {
+    int depth = 0;                          // آخرین عمق کامل
+    long long nodes = 0;
+    double elapsed_ms = 0.0;
+    vector<AnalysisLine> lines;             // مرتب نزولی بر اساس ارزش
+};
+
+// ============================================================================
+// عامل Minimax
+// ============================================================================
+
+class MinimaxAgent : public CheckersAgent {
+protected:
+    int depth;
+    bool use_alpha_beta;
+    string eval_func;
+    int nodes_expanded;
+    
+    // آمار آخرین جستجو
+    SearchStats stats;
+    bool log_stats = false;
+    bool hardware_counters = TRACING;     // شمارنده‌های perf در هر جستجو
+    chrono::steady_clock::time_point search_start;
+    
+    // تعریف تابع ارزیابی
+    using EvalFunc = function<double(const CheckersGame&, PieceType)>;
+    unordered_map<string, EvalFunc> eval_functions;
+    
+    // ارزیاب آموزش‌دیده با TD(λ)
+    LinearEvaluator learned_eval;
+    string weights_file = "checkers_weights.dat";
+    
+    // شبکه NNUE (مشترک بین کپی‌های بازی در جستجو)
+    shared_ptr<NNUENetwork> nnue_net;
+    string nnue_file = "checkers_nnue.dat";
+    
+    SearchOptions options;
+    
+    // موقعیت‌های حل‌شده: حرکت بدون جستجو
+    shared_ptr<const SolvedTable> solved = defaultSolvedTable();
+    long long solved_moves = 0;
+    
+    // جدول جابجایی؛ مقادیر از دید tt_player ذخیره می‌شوند
+    bool use_tt = true;
+    TranspositionTable tt;
+    PieceType tt_player = PieceType::EMPTY;
+    
+    // ponder: جستجوی پاسخ پیش‌بینی‌شده حریف در نخ جداگانه
+    thread ponder_thread;
+    atomic<bool> ponder_stop{false};
+    uint64_t ponder_hash = 0;
+    Move ponder_move;
+    int ponder_depth = 0;
+    long long ponder_hits = 0;
+    
+    // محدودیت‌های جستجوی جاری؛ aborted پس از رسیدن به آن‌ها تنظیم می‌شود
+    SearchLimits limits;
+    chrono::steady_clock::time_point deadline;
+    bool aborted = false;
+    
+    bool abortRequested() {
+        if (aborted) {
+            return true;
+        }
+        if (limits.stop != nullptr && limits.stop->load(memory_order_relaxed)) {
+            aborted = true;
+        } else if (limits.nodes > 0 && stats.nodes >= limits.nodes) {
+            aborted = true;
+        } else if (limits.movetime_ms > 0 && (stats.nodes & 1023) == 0 &&
+                   chrono::steady_clock::now() >= deadline) {
+            aborted = true;
+        }
+        return aborted;
+    }
+    
+public:
+    MinimaxAgent(PieceType p, int d =3, bool ab = true, string ef = "basic") 
+        : CheckersAgent(p, "Minimax Agent"), depth(d), use_alpha_beta(ab), 
+          eval_func(ef), nodes_expanded(0) {
+        
+        name = "Minimax (d=" + to_string(depth) + ", AB=" + (use_alpha_beta ? "Y" : "N") + ")";
+        
+        // ثبت توابع ارزیابی
+        eval_functions["basic"] = [this](const CheckersGame& game, PieceType player) {
+            return evaluateBasic(game, player);
+        };
+        eval_functions["advanced"] = [this](const CheckersGame& game, PieceType player) {
+            return evaluateAdvanced(game, player);
+        };
+        
+        eval_functions["positional"] = [this](const CheckersGame& game, PieceType player) {
+            return evaluatePositional(game, player);
+        };
+        
+        eval_functions["learned"] = [this](const CheckersGame& game, PieceType player) {
+            return learned_eval.evaluate(game, player);
+        };
+        
+        eval_functions["nnue"] = [this](const CheckersGame& game, PieceType player) {
+            return evaluateNNUE(game, player);
+        };
+        
+        if (eval_func == "learned") {
+            learned_eval.loadWeights(weights_file);
+        }
+        
+        if (eval_func == "nnue") {
+            // در نبود فایل، وزن‌های پیش‌فرض (معادل مادی) استفاده می‌شوند
+            nnue_net = make_shared<NNUENetwork>();
+            nnue_net->loadWeights(nnue_file);
+        }
+    }
+    
+    // بارگذاری وزن‌های NNUE از فایل دیگر
+    bool loadNNUEWeights(const string& filename) {
+        nnue_file = filename;
+        if (!nnue_net) {
+            nnue_net = make_shared<NNUENetwork>();
+        }
+        return nnue_net->loadWeights(filename);
+    }
+    
+    // بارگذاری وزن‌های ارزیاب آموزش‌دیده از فایل دیگر
+    bool loadLearnedWeights(const string& filename) {
+        weights_file = filename;
+        return learned_eval.loadWeights(filename);
+    }
+    
+    virtual ~MinimaxAgent() {
+        stopPondering();
+    }
+    
+    // شروع و پایان اندازه‌گیری یک جستجو
+    void beginSearch() {
+        nodes_expanded = 0;
+        stats.reset(depth);
+        if (hardware_counters) {
+            HardwareCounters::forThread().start();
+        }
+        search_start = chrono::steady_clock::now();
+        if (tt_player != player) {
+            tt.clear();
+            tt_player = player;
+        }
+        tt.newSearch();
+    }
+    
+    void endSearch() {
+        stats.elapsed_ms = chrono::duration<double, milli>(
+            chrono::steady_clock::now() - search_start).count();
+        if (hardware_counters) {
+            stats.hardware = HardwareCounters::forThread().stop();
+        }
+        TraceSpan span("search", "search");
+        span.setStart(search_start);
+        span.arg("depth", stats.depth);
+        span.arg("nodes", stats.nodes);
+        if (stats.hardware.valid) {
+            span.arg("cycles", stats.hardware.cycles);
+            span.arg("instructions", stats.hardware.instructions);
+            span.arg("cache_misses", stats.hardware.cache_misses);
+            span.arg("branch_misses", stats.hardware.branch_misses);
+        }
+        if (log_stats) {
+            clog << stats.toLogLine(name) << endl;
+        }
+    }
+    
+    using CheckersAgent::getMove;
+    
+    virtual Move getMove(const CheckersGame& game) override {
+        stopPondering();
+        if (ponderHit(game)) {
+            return ponder_move;
+        }
+        Move solved_move;
+        if (solvedMove(game, solved_move)) {
+            return solved_move;
+        }
+        beginSearch();
+        Move best_move = searchRoot(game);
+        endSearch();
+        return best_move;
+    }
+    
+    // نسخه قابل توقف: عمیق‌شونده تا depth؛ پس از توقف بهترین عمق کامل
+    Move getMove(const CheckersGame& game, const StopToken& stop) override {
+        stopPondering();
+        if (ponderHit(game)) {
+            return ponder_move;
+        }
+        Move solved_move;
+        if (solvedMove(game, solved_move)) {
+            return solved_move;
+        }
+        SearchLimits search_limits;
+        search_limits.depth = depth;
+        search_limits.stop = stop.get();
+        return searchIterative(game, search_limits, nullptr);
+    }
+    
+    // شروع ponder روی موقعیت پس از پاسخ مورد انتظار حریف (حرکت برتر جدول)
+    void startPondering(const CheckersGame& game) override {
+        stopPondering();
+        if (game.isGameOver() || game.getCurrentPlayer() == player || !use_alpha_beta || !use_tt) {
+            return;
+        }
+        const TTEntry* entry = tt.probe(game.getHash());
+        if (entry == nullptr) {
+            return;
+        }
+        MovePicker<CheckersGame> picker(game, entry->best_from, entry->best_to);
+        Move reply;
+        while (picker.next(reply) && !picker.isHashMove(reply)) {
+        }
+        if (!picker.isHashMove(reply)) {
+            return;
+        }
+        CheckersGame expected = game.copy();
+        expected.applyMove(reply);
+        if (expected.isGameOver()) {
+            return;
+        }
+        
+        ponder_hash = expected.getHash();
+        ponder_move = Move();
+        ponder_depth = 0;
+        ponder_stop = false;
+        ponder_thread = thread([this, expected]() {
+            SearchLimits search_limits;
+            search_limits.depth = PONDER_MAX_DEPTH;
+            search_limits.stop = &ponder_stop;
+            searchIterative(expected, search_limits, [this](const SearchInfo& info) {
+                ponder_move = info.pv[0];
+                ponder_depth = info.depth;
+            });
+        });
+    }
+    
+    void stopPondering() override {
+        ponder_stop = true;
+        if (ponder_thread.joinable()) {
+            ponder_thread.join();
+        }
+    }
+    
+    long long getPonderHits() const { return ponder_hits; }
+    void setTranspositionTable(bool enabled) { use_tt = enabled; }
+    void clearTranspositionTable() { tt.clear(); }
+    
+    void setSolvedTable(shared_ptr<const SolvedTable> table) { solved = move(table); }
+    long long getSolvedMoves() const { return solved_moves; }
+    
+    // حرکت از جدول حل‌شده: حرکت ثبت‌شده موقعیت، یا حرکتی که حریف را در
+    // موقعیت باخته ثبت‌شده قرار می‌دهد. حل‌کننده تکرار را نمی‌بیند، پس حرکتی که به
+    // موقعیتی از تاریخچه بازی برگردد رد می‌شود و جستجو تصمیم می‌گیرد
+    bool solvedMove(const CheckersGame& game, Move& move) {
+        if (!solved || solved->empty()) {
+            return false;
+        }
+        vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+        auto it = solved->find(solvedKey(game));
+        if (it != solved->end() && it->second.best_from != 0) {
+            for (const auto& candidate : moves) {
+                if (MovePicker<CheckersGame>::fromSquare(candidate) == it->second.best_from &&
+                    MovePicker<CheckersGame>::toSquare(candidate) == it->second.best_to) {
+                    CheckersGame child = game.copy();
+                    child.applyMove(candidate);
+                    if (child.isRepetition()) {
+                        break;
+                    }
+                    move = candidate;
+                    solved_moves++;
+                    return true;
+                }
+            }
+        }
+        for (const auto& candidate : moves) {
+            CheckersGame child = game.copy();
+            child.applyMove(candidate);
+            if (child.isRepetition()) {
+                continue;
+            }
+            auto child_it = solved->find(solvedKey(child));
+            if (child_it != solved->end() && child_it->second.value == SolvedValue::LOSS) {
+                move = candidate;
+                solved_moves++;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void setSearchOptions(const SearchOptions& search_options) {
+        options = search_options;
+        name = "Minimax (d=" + to_string(depth) + ", AB=" + (use_alpha_beta ? "Y" : "N") + ")" +
+               options.suffix();
+    }
+    const SearchOptions& getSearchOptions() const { return options; }
+    
+protected:
+    static const int PONDER_MAX_DEPTH = 64;
+    
+    // حریف همان حرکت پیش‌بینی‌شده را بازی کرده و ponder به عمق عامل رسیده است
+    bool ponderHit(const CheckersGame& game) {
+        bool hit = ponder_depth >= depth && game.getHash() == ponder_hash &&
+                   game.getCurrentPlayer() == player;
+        ponder_depth = 0;
+        if (hit) {
+            ponder_hits++;
+        }
+        return hit;
+    }
+    
+public:
+    
+    // جستجوی همه حرکات ریشه تا عمق depth
+    Move searchRoot(const CheckersGame& game) {
+        vector<Move> moves = game.getAllValidMoves(player);
+        if (moves.empty()) {
+            return Move();
+        }
+        
+        vector<Move> pv;
+        searchRootDepth(attachRoot(game), moves, depth, pv, false);
+        return pv.empty() ? Move() : pv[0];
+    }
+    
+    // اتصال NNUE به ریشه؛ کپی‌های جستجو accumulator را به ارث می‌برند
+    CheckersGame attachRoot(const CheckersGame& game) const {
+        CheckersGame root = game.copy();
+        if (nnue_net && root.getNNUE() != nnue_net.get()) {
+            root.attachNNUE(nnue_net.get());
+        }
+        return root;
+    }
+    
+    // یک جستجوی کامل ریشه تا عمق search_depth؛ pv: بهترین خط (یا فقط بهترین حرکت
+    // وقتی collect_pv خاموش است)، خروجی: ارزش آن
+    double searchRootDepth(const CheckersGame& root, const vector<Move>& moves, int search_depth,
+                           vector<Move>& pv, bool collect_pv = true) {
+        stats.countNode(0);
+        
+        double best_value = -numeric_limits<double>::infinity();
+        pv.clear();
+        vector<Move> child_pv;
+        
+        // ارزیابی هر حرکت؛ مقدار بهترین حرکت تا اینجا کران پایین بقیه است
+        for (const auto& move : moves) {
+            stats.countMove(move);
+            CheckersGame game_copy = root.copy();
+            game_copy.applyMove(move);
+            child_pv.clear();
+            
+            double value;
+            if (use_alpha_beta) {
+                value = alphaBeta(game_copy, search_depth - 1, best_value,
+                                 numeric_limits<double>::infinity(), false,
+                                 collect_pv ? &child_pv : nullptr);
+            } else {
+                value = minimax(game_copy, search_depth - 1, false, collect_pv ? &child_pv : nullptr);
+            }
+            if (aborted) {
+                break;
+            }
+            
+            if (value > best_value) {
+                best_value = value;
+                pv.assign(1, move);
+                pv.insert(pv.end(), child_pv.begin(), child_pv.end());
+            }
+        }
+        
+        return best_value;
+    }
+    
+    // عمیق‌شونده تکراری با محدودیت عمق/زمان/گره و توقف خارجی؛
+    // on_info پس از هر عمق کامل صدا زده می‌شود. حرکت بهترین عمق کامل برگردانده می‌شود.
+    Move searchIterative(const CheckersGame& game, const SearchLimits& search_limits,
+                         const function<void(const SearchInfo&)>& on_info) {
+        const int saved_depth = depth;
+        const int max_depth = search_limits.depth > 0 ? search_limits.depth : depth;
+        
+        depth = max_depth;
+        beginSearch();
+        limits = search_limits;
+        aborted = false;
+        deadline = search_start + chrono::milliseconds(limits.movetime_ms);
+        
+        vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+        PieceType saved_player = player;
+        player = game.getCurrentPlayer();
+        
+        Move best_move;
+        CheckersGame root = attachRoot(game);
+        for (int d = 1; d <= max_depth && !moves.empty(); d++) {
+            TraceSpan span("iteration", "search");
+            span.arg("depth", d);
+            depth = d;
+            vector<Move> pv;
+            double value = searchRootDepth(root, moves, d, pv);
+            if (aborted && d > 1) {
+                break;   // تکرار ناقص کنار گذاشته می‌شود
+            }
+            if (pv.empty()) {
+                break;
+            }
+            best_move = pv[0];
+            stats.depth = d;
+            
+            SearchInfo info;
+            info.depth = d;
+            info.score = value;
+            info.nodes = stats.nodes;
+            info.elapsed_ms = chrono::duration<double, milli>(
+                chrono::steady_clock::now() - search_start).count();
+            info.pv = pv;
+            if (on_info) {
+                on_info(info);
+            }
+            
+            // بهترین حرکت عمق قبلی ابتدا جستجو می‌شود
+            auto it = find_if(moves.begin(), moves.end(),
+                              [&](const Move& m) { return moveToString(m) == moveToString(best_move); });
+            rotate(moves.begin(), it, it + 1);
+            
+            if (aborted || fabs(value) >= 1000.0) {
+                break;
+            }
+        }
+        
+        // توقف پیش از پایان عمق 1: نخستین حرکت قانونی
+        if (best_move.to.empty() && !moves.empty()) {
+            best_move = moves[0];
+        }
+        
+        endSearch();
+        limits = SearchLimits();
+        aborted = false;
+        player = saved_player;
+        depth = saved_depth;
+        return best_move;
+    }
+    // تحلیل چندخطی با عمیق‌شونده تکراری: multipv حرکت برتر ریشه با ارزش و خط
+    // اصلی هر کدام. حرکات بدتر از multipv-امین خط فقط تا همان کران جستجو می‌شوند.
+    AnalysisResult analyze(const CheckersGame& game, int multipv, const SearchLimits& search_limits) {
+        const int saved_depth = depth;
+        const int max_depth = search_limits.depth > 0 ? search_limits.depth : depth;
+        
+        depth = max_depth;
+        beginSearch();
+        limits = search_limits;
+        aborted = false;
+        deadline = search_start + chrono::milliseconds(limits.movetime_ms);
+        
+        PieceType saved_player = player;
+        player = game.getCurrentPlayer();
+        multipv = max(1, multipv);
+        
+        vector<AnalysisLine> root_lines;
+        for (const auto& move : game.getAllValidMoves(player)) {
+            AnalysisLine line;
+            line.move = move;
+            root_lines.push_back(line);
+        }
+        
+        AnalysisResult result;
+        CheckersGame root = attachRoot(game);
+        for (int d = 1; d <= max_depth && !root_lines.empty(); d++) {
+            TraceSpan span("iteration", "search");
+            span.arg("depth", d);
+            span.arg("multipv", multipv);
+            depth = d;
+            vector<AnalysisLine> lines = root_lines;
+            size_t searched = searchRootMultiPV(root, lines, d, multipv);
+            if ((aborted && d > 1) || searched == 0) {
+                break;   // تکرار ناقص کنار گذاشته می‌شود
+            }
+            lines.resize(searched);
+            stable_sort(lines.begin(), lines.end(),
+                        [](const AnalysisLine& a, const AnalysisLine& b) { return a.score > b.score; });
+            
+            // ترتیب این عمق، ترتیب جستجوی عمق بعد است
+            if (searched == root_lines.size()) {
+                root_lines = lines;
+            }
+            result.depth = d;
+            result.lines.assign(lines.begin(), lines.begin() + min<size_t>(multipv, lines.size()));
+            stats.depth = d;
+            
+            if (aborted || fabs(lines[0].score) >= 1000.0) {
+                break;
+            }
+        }
+        
+        result.nodes = stats.nodes;
+        result.elapsed_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - search_start).count();
+        endSearch();
+        limits = SearchLimits();
+        aborted = false;
+        player = saved_player;
+        depth = saved_depth;
+        return result;
+    }
+    
+    // جستجوی ریشه برای multipv خط: کران پایین هر حرکت ارزش multipv-امین بهترین
+    // حرکت تا اینجاست. خروجی: تعداد حرکات جستجوشده (کمتر از همه هنگام توقف)
+    size_t searchRootMultiPV(const CheckersGame& root, vector<AnalysisLine>& lines, int search_depth,
+                             int multipv) {
+        stats.countNode(0);
+        
+        vector<double> best_values;             // multipv بهترین ارزش، نزولی
+        vector<Move> child_pv;
+        size_t searched = 0;
+        for (auto& line : lines) {
+            double alpha = static_cast<int>(best_values.size()) >= multipv
+                               ? best_values.back() : -numeric_limits<double>::infinity();
+            stats.countMove(line.move);
+            CheckersGame game_copy = root.copy();
+            game_copy.applyMove(line.move);
+            child_pv.clear();
+            
+            double value;
+            if (use_alpha_beta) {
+                value = alphaBeta(game_copy, search_depth - 1, alpha,
+                                  numeric_limits<double>::infinity(), false, &child_pv);
+            } else {
+                value = minimax(game_copy, search_depth - 1, false, &child_pv);
+            }
+            if (aborted) {
+                break;
+            }
+            
+            line.score = value;
+            updatePV(line.pv, line.move, child_pv);
+            best_values.insert(upper_bound(best_values.begin(), best_values.end(), value, greater<double>()),
+                               value);
+            if (static_cast<int>(best_values.size()) > multipv) {
+                best_values.pop_back();
+            }
+            searched++;
+        }
+        return searched;
+    }
+    
+    static constexpr double NULL_WINDOW = 1e-6;
+    
+    // کاهش عمق LMR: فقط حرکات ساده و غیرشاه‌شونده پس از lmr_min_index
+    int lateMoveReduction(size_t index, int depth, const Move& move) const {
+        if (!options.lmr || depth < options.lmr_min_depth ||
+            static_cast<int>(index) < options.lmr_min_index || move.is_capture || move.becomes_king) {
+            return 0;
+        }
+        return (static_cast<int>(index) >= 2 * options.lmr_min_index &&
+                depth >= options.lmr_min_depth + 2) ? 2 : 1;
+    }
+    
+    // خط اصلی: حرکت فعلی و سپس خط اصلی فرزند
+    static void updatePV(vector<Move>& pv, const Move& move, const vector<Move>& child_pv) {
+        pv.assign(1, move);
+        pv.insert(pv.end(), child_pv.begin(), child_pv.end());
+    }
+    
+    // الگوریتم Minimax استاندارد
+    double minimax(CheckersGame& game, int depth, bool maximizing_player,
+                   vector<Move>* pv = nullptr) {
+        if (abortRequested()) {
+            return 0.0;
+        }
+        nodes_expanded++;
+        stats.countNode(this->depth - depth);
+        
+        // موقعیت تکراری: مساوی، بدون جستجوی بیشتر چرخه
+        if (game.isRepetition()) {
+            stats.repetitions++;
+            return 0.0;
+        }
+        
+        if (depth == 0 || game.isGameOver()) {
+            stats.leaf_evals++;
+            return evaluate(game);
+        }
+        
+        PieceType current_player = game.getCurrentPlayer();
+        vector<Move> moves = game.getAllValidMoves(current_player);
+        
+        vector<Move> child_pv;
+        vector<Move>* child_pv_ptr = pv ? &child_pv : nullptr;
+        
+        if (maximizing_player) {
+            double max_eval = -numeric_limits<double>::infinity();
+            for (const auto& move : moves) {CheckersGame game_copy = game.copy();
+                stats.countMove(move);
+                game_copy.applyMove(move);
+                child_pv.clear();
+                double eval = minimax(game_copy, depth - 1, false, child_pv_ptr);
+                if (eval > max_eval && pv) {
+                    updatePV(*pv, move, child_pv);
+                }
+                max_eval = max(max_eval, eval);
+            }
+            return max_eval;
+        } else {
+            double min_eval = numeric_limits<double>::infinity();
+            for (const auto& move : moves) {
+                stats.countMove(move);
+                CheckersGame game_copy = game.copy();
+                game_copy.applyMove(move);
+                child_pv.clear();
+                double eval = minimax(game_copy, depth - 1, true, child_pv_ptr);
+                if (eval < min_eval && pv) {
+                    updatePV(*pv, move, child_pv);
+                }
+                min_eval = min(min_eval, eval);
+            }
+            return min_eval;
+        }
+    }
+    
+    // الگوریتم Alpha-Beta Pruning
+    double alphaBeta(CheckersGame& game, int depth, double alpha, double beta, 
+                    bool maximizing_player, vector<Move>* pv = nullptr) {
+        if (abortRequested()) {
+            return 0.0;
+        }
+        nodes_expanded++;
+        stats.countNode(this->depth - depth);
+        
+        // موقعیت تکراری: مساوی، بدون جستجوی بیشتر چرخه
+        if (game.isRepetition()) {
+            stats.repetitions++;
+            return 0.0;
+        }
+        
+        if (depth == 0 || game.isGameOver()) {
+            stats.leaf_evals++;
+            return evaluate(game);
+        }
+        
+        // جدول جابجایی: برش با کران ذخیره‌شده و حرکت برتر قبلی
+        const double alpha_orig = alpha;
+        const double beta_orig = beta;
+        int hash_from = 0;
+        int hash_to = 0;
+        if (use_tt) {
+            stats.cache_probes++;
+            if (const TTEntry* entry = tt.probe(game.getHash())) {
+                stats.cache_hits++;
+                hash_from = entry->best_from;
+                hash_to = entry->best_to;
+                if (entry->depth >= depth) {
+                    if (entry->bound == TranspositionTable::EXACT) {
+                        return entry->value;
+                    } else if (entry->bound == TranspositionTable::LOWER) {
+                        alpha = max(alpha, entry->value);
+                    } else if (entry->bound == TranspositionTable::UPPER) {
+                        beta = min(beta, entry->value);
+                    }
+                    if (alpha >= beta) {
+                        return entry->value;
+                    }
+                }
+            }
+        }
+        
+        // حرکات به‌صورت تنبل: حرکت جدول، captureها، سپس حرکات ساده
+        MovePicker<CheckersGame> picker(game, hash_from, hash_to);
+        
+        // futility: در گره بدون capture نزدیک برگ، اگر ارزیابی ایستا با حاشیه
+        // هم به پنجره نرسد، حرکات ساده جستجو نمی‌شوند
+        if (options.futility && !picker.hasCaptures() && depth <= options.futility_max_depth) {
+            double margin = options.futility_margin * depth;
+            double static_eval = evaluate(game);
+            if (maximizing_player && static_eval + margin <= alpha) {
+                stats.futility_prunes++;
+                return static_eval + margin;
+            }
+            if (!maximizing_player && static_eval - margin >= beta) {
+                stats.futility_prunes++;
+                return static_eval - margin;
+            }
+        }
+        
+        // ProbCut: اگر جستجوی کم‌عمق یکی از حرکات اول با حاشیه از پنجره بیرون بزند،
+        // جستجوی کامل هم به احتمال زیاد برش می‌دهد
+        if (options.probcut && depth >= options.probcut_min_depth &&
+            fabs(maximizing_player ? beta : alpha) < 1000.0) {
+            int shallow = depth - 1 - options.probcut_reduction;
+            MovePicker<CheckersGame> probcut_picker(game, hash_from, hash_to);
+            Move move;
+            for (int i = 0; i < options.probcut_moves && probcut_picker.next(move); i++) {
+                CheckersGame game_copy = game.copy();
+                game_copy.applyMove(move);
+                if (maximizing_player) {
+                    double beta_cut = beta + options.probcut_margin;
+                    double value = alphaBeta(game_copy, shallow, beta_cut - NULL_WINDOW, beta_cut, false);
+                    if (value >= beta_cut) {
+                        stats.probcut_cuts++;
+                        return value;
+                    }
+                } else {
+                    double alpha_cut = alpha - options.probcut_margin;
+                    double value = alphaBeta(game_copy, shallow, alpha_cut, alpha_cut + NULL_WINDOW, true);
+                    if (value <= alpha_cut) {
+                        stats.probcut_cuts++;
+                        return value;
+                    }
+                }
+            }
+        }
+        vector<Move> child_pv;
+        vector<Move>* child_pv_ptr = pv ? &child_pv : nullptr;
+        double best_eval;
+        Move move;
+        int best_from = 0;
+        int best_to = 0;
+        
+        if (maximizing_player) {
+            double max_eval = -numeric_limits<double>::infinity();
+            for (size_t i = 0; picker.next(move); i++) {
+                stats.countMove(move);
+                CheckersGame game_copy = game.copy();
+                game_copy.applyMove(move);
+                child_pv.clear();
+                double eval;
+                int reduction = lateMoveReduction(i, depth, move);
+                if (reduction > 0) {
+                    stats.lmr_reductions++;
+                    eval = alphaBeta(game_copy, depth - 1 - reduction, alpha, beta, false, child_pv_ptr);
+                    if (eval > alpha) {
+                        stats.lmr_researches++;
+                        child_pv.clear();
+                        eval = alphaBeta(game_copy, depth - 1, alpha, beta, false, child_pv_ptr);
+                    }
+                } else {
+                    eval = alphaBeta(game_copy, depth - 1, alpha, beta, false, child_pv_ptr);
+                }
+                if (eval > max_eval) {
+                    best_from = MovePicker<CheckersGame>::fromSquare(move);
+                    best_to = MovePicker<CheckersGame>::toSquare(move);
+                    if (pv) updatePV(*pv, move, child_pv);
+                }
+                max_eval = max(max_eval, eval);
+                alpha = max(alpha, eval);
+                if (beta <= alpha) {
+                    stats.countCutoff(i);
+                    break; // Beta cutoff
+                }
+            }
+            best_eval = max_eval;
+        } else {
+            double min_eval = numeric_limits<double>::infinity();
+            for (size_t i = 0; picker.next(move); i++) {
+                stats.countMove(move);
+                CheckersGame game_copy = game.copy();
+                game_copy.applyMove(move);
+                child_pv.clear();
+                double eval;
+                int reduction = lateMoveReduction(i, depth, move);
+                if (reduction > 0) {
+                    stats.lmr_reductions++;
+                    eval = alphaBeta(game_copy, depth - 1 - reduction, alpha, beta, true, child_pv_ptr);
+                    if (eval < beta) {
+                        stats.lmr_researches++;
+                        child_pv.clear();
+                        eval = alphaBeta(game_copy, depth - 1, alpha, beta, true, child_pv_ptr);
+                    }
+                } else {
+                    eval = alphaBeta(game_copy, depth - 1, alpha, beta, true, child_pv_ptr);
+                }
+                if (eval < min_eval) {
+                    best_from = MovePicker<CheckersGame>::fromSquare(move);
+                    best_to = MovePicker<CheckersGame>::toSquare(move);
+                    if (pv) updatePV(*pv, move, child_pv);
+                }
+                min_eval = min(min_eval, eval);
+                beta = min(beta, eval);
+                if (beta <= alpha) {
+                    stats.countCutoff(i);
+                    break; // Alpha cutoff
+                }
+            }
+            best_eval = min_eval;
+        }
+        
+        if (use_tt && !aborted) {
+            TranspositionTable::Bound bound = TranspositionTable::EXACT;
+            if (best_eval <= alpha_orig) {
+                bound = TranspositionTable::UPPER;
+            } else if (best_eval >= beta_orig) {
+                bound = TranspositionTable::LOWER;
+            }
+            tt.store(game.getHash(), depth, best_eval, bound, best_from, best_to);
+        }
+        return best_eval;
+    }
+    
+    // تابع ارزیابی اصلی
+    double evaluate(const CheckersGame& game) {
+        TraceSpan span("evaluate", "eval");
+        if (game.isGameOver()) {
+            PieceType winner = game.getWinner();
+            if (winner == player) {
+                return 1000.0;
+            } else if (winner == PieceType::EMPTY) {
+                return 0.0;} else {
+                return -1000.0;
+            }
+        }
+        
+        return eval_functions.at(eval_func)(game, player);
+    }
+    
+    // ماتریس ارزش موقعیت: 6x6 از EvalParams؛ برای صفحه‌های دیگر
+    // 0.2 در مرکز، 0.1 در سایر خانه‌ها و 0 در ردیف اول
+    template<int N>
+    static const array<array<double, N>, N>& positionalTable() {
+        if constexpr (N == 6) {
+            return evalParams().table;
+        } else {
+            static const array<array<double, N>, N> table = []() {
+                array<array<double, N>, N> t{};
+                for (int i = 1; i < N; i++) {
+                    for (int j = 0; j < N; j++) {
+                        if ((i + j) % 2 == 0) continue;
+                        bool center = i >= 2 && i <= N - 3 && j >= 2 && j <= N - 3;
+                        t[i][j] = center ? 0.2 : 0.1;
+                    }
+                }
+                return t;
+            }();
+            return table;
+        }
+    }
+    
+    // تابع ارزیابی پایه
+    template<class Game>
+    static double evaluateBasic(const Game& game, PieceType player) {
+        const EvalParams& params = evalParams();
+        double score = 0.0;
+        const auto& board = game.getBoard();
+        
+        for (int i = 0; i < Game::SIZE; i++) {
+            for (int j = 0; j < Game::SIZE; j++) {PieceType piece = board[i][j];
+                
+                if (piece == PieceType::EMPTY || !game.isBlackSquare({i, j})) {
+                    continue;
+                }
+                
+                double piece_value = 0.0;
+                
+                if (piece == player) {
+                    piece_value = params.man(); // مهره معمولی خودی
+                } else if ((player == PieceType::BLACK_PIECE && piece == PieceType::BLACK_KING) ||(player == PieceType::WHITE_PIECE && piece == PieceType::WHITE_KING)) {
+                    piece_value = params.king(); // شاه خودی
+                } else if (piece == PieceType::BLACK_PIECE || piece == PieceType::WHITE_PIECE) {
+                    piece_value = -params.man(); // مهره معمولی حریف
+                } else {
+                    piece_value = -params.king(); // شاه حریف
+                }
+                
+                score += piece_value;
+            }
+        }
+        
+        return score;
+    }
+    // تابع ارزیابی پیشرفته
+    template<class Game>
+    static double evaluateAdvanced(const Game& game, PieceType player) {
+        double score = evaluateBasic(game, player);
+        const auto& board = game.getBoard();
+        const double advancement = evalParams().advancement();
+        
+        // ماتریس ارزش موقعیت
+        const auto& positional_value = positionalTable<Game::SIZE>();
+        for (int i = 0; i < Game::SIZE; i++) {
+            for (int j = 0; j < Game::SIZE; j++) {
+                if (!game.isBlackSquare({i, j})) continue;
+                
+                PieceType piece = board[i][j];
+                PieceType piece_color = game.getPieceColor(piece);
+                
+                if (piece_color == player) {
+                    // امتیاز موقعیت برای مهره‌های خودی
+                    score += positional_value[i][j];
+                       // امتیاز برای نزدیکی به تبدیل شدن به شاه
+                    if (!game.isKing(piece)) {
+                        if (player == PieceType::BLACK_PIECE) {
+                            score += i * advancement; // سیاه: هر چه پایین‌تر بهتر
+                        } else {
+                            score += (Game::SIZE - 1 - i) * advancement; // سفید: هر چه بالاتر بهتر
+                        }
+                    }
+                } else if (piece_color != PieceType::EMPTY) {
+                    // کسر امتیاز برای مهره‌های حریف
+                    score -= positional_value[i][j];
+                }
+            }
+        }
+        
+        return score;
+    }
+    
+    // تابع ارزیابی موقعیتی
+    template<class Game>
+    static double evaluatePositional(const Game& game, PieceType player) {
+        double score = evaluateBasic(game, player);
+        
+        // اهمیت مهره‌های دفاعی و تهاجمی
+        const auto& board = game.getBoard();
+        const EvalParams& params = evalParams();
+        
+        for (int i = 0; i < Game::SIZE; i++) {
+            for (int j = 0; j < Game::SIZE; j++) {
+                if (!game.isBlackSquare({i, j})) continue;
+                
+                PieceType piece = board[i][j];
+                PieceType piece_color = game.getPieceColor(piece);
+                
+                if (piece_color == player) {
+                    // مهره‌های در خانه‌های امن (مرکزی) ارزش بیشتری دارند
+                    if (j >= 1 && j <= Game::SIZE - 2) {
+                        score += params.centerBonus();
+                    }
+                    
+                    // مهره‌های نزدیک به دیوار آسیب‌پذیر هستند
+                    if (j == 0 || j == Game::SIZE - 1) {
+                        score -= params.edgePenalty();
+                    }
+                }
+            }
+        }
+        
+        return score;
+    }
+    
+    // ارزیابی NNUE؛ در صورت نبود accumulator افزایشی، محاسبه کامل
+    double evaluateNNUE(const CheckersGame& game, PieceType player) {
+        if (!nnue_net) {
+            nnue_net = make_shared<NNUENetwork>();
+        }
+        
+        double black_score;
+        if (game.getNNUE() == nnue_net.get()) {
+            black_score = nnue_net->evaluate(game.getNNUEAccumulator());
+        } else {
+            NNUEAccumulator acc;
+            nnue_net->refresh(game.getBoard(), acc);
+            black_score = nnue_net->evaluate(acc);
+        }
+        
+        return (player == PieceType::BLACK_PIECE) ? black_score : -black_score;
+    }
+    
+    int getNodesExpanded() const { return nodes_expanded; }
+    const SearchStats& getLastSearchStats() const { return stats; }
+    
+    // آیا نام ارزیاب (basic، advanced، ...) ثبت شده است؟
+    bool hasEvaluator(const string& name) const { return eval_functions.count(name) > 0; }
+    
+    // چاپ یک خط JSON آمار در clog پس از هر جستجو
+    void setStatsLogging(bool enabled) { log_stats = enabled; }
+    void setHardwareCounters(bool enabled) { hardware_counters = enabled; }
+};
+
+// ============================================================================
+// عامل یادگیرنده
+// ============================================================================
+
+class LearningAgent : public MinimaxAgent {
+private:
+    double learning_rate;
+    unordered_map<string, pair<double, Move>, BoardKeyHash> experience;
+    string experience_file;
+    
+public:
+    LearningAgent(PieceType p, int d = 3, bool ab = true, 
+                 string ef = "basic", double lr = 0.1,
+                 string exp_file = "checkers_experience.dat")
+        : MinimaxAgent(p, d, ab, ef), learning_rate(lr), experience_file(exp_file) {
+        name = "Learning Agent (d=" + to_string(depth) + ")";
+        loadExperience();
+    }
+    
+    ~LearningAgent() {
+        saveExperience();
+    }
+    
+    using MinimaxAgent::getMove;
+    
+    Move getMove(const CheckersGame& game) override {
+        stopPondering();
+        beginSearch();
+        vector<Move> moves = game.getAllValidMoves(player);
+        
+        if (moves.empty()) {
+            endSearch();
+            return Move();
+        }
+        
+        // بررسی تجربیات گذشته
+        string board_key = game.getBoardKey();
+        auto it = experience.find(board_key);
+        stats.cache_probes++;
+        if (it != experience.end()) {
+            const Move& stored_move = it->second.second;
+            
+            // بررسی معتبر بودن حرکت ذخیره شده
+            for (const auto& move : moves) {
+                if (movesEqual(move, stored_move)) {
+                    stats.cache_hits++;
+                    endSearch();
+                    return move;
+                }
+            }
+        }
+        
+        // استفاده از Minimax
+        Move move = searchRoot(game);
+        endSearch();
+        return move;
+    }
+    
+    // یادگیری از بازی
+    void learnFromGame(const vector<Move>& game_history, double result) {
+        // result: 1.0 برای برد، 0.0 برای مساوی، -1.0 برای باخت
+        
+        for (size_t i = 0; i < game_history.size(); i++) {
+            double move_value = result * (1.0 - static_cast<double>(i) / game_history.size());
+            
+            const Move& move = game_history[i];
+            if (!move.board_before.empty()) {
+                string key = move.board_before;
+                auto it = experience.find(key);
+                
+                if (it != experience.end()) {
+                    // به‌روزرسانی تجربه موجود
+                    double old_value = it->second.first;
+                    double new_value = old_value + learning_rate * (move_value - old_value);
+                    it->second = make_pair(new_value, move);
+                } else {
+                    // افزودن تجربه جدید
+                    experience[key] = make_pair(move_value, move);
+                }
+            }
+        }
+        
+        saveExperience();
+    }
+    
+    // افزودن مستقیم یک تجربه
+    void addExperience(const string& key, double value, const Move& move) {
+        experience[key] = make_pair(value, move);
+    }
+    
+    size_t getExperienceSize() const { return experience.size(); }
+    
+    // مقایسه دو حرکت
+    bool movesEqual(const Move& m1, const Move& m2) const {
+        if (m1.from != m2.from) return false;
+        if (m1.to.empty() || m2.to.empty()) return false;
+        return m1.to.back() == m2.to.back();
+    }
+    
+    // ذخیره تجربیات؛ در فایل موقت و سپس rename، تا پردازه‌های دیگری که همین فایل را
+    // می‌خوانند (کارگرهای distribute) هرگز فایل نیمه‌نوشته نبینند
+    void saveExperience() {
+        TraceSpan span("saveExperience", "io");
+        span.arg("entries", static_cast<long long>(experience.size()));
+#ifdef CHECKERS_HAVE_PROCESSES
+        string temp_file = experience_file + ".tmp" + to_string(getpid());
+#else
+        string temp_file = experience_file + ".tmp";
+#endif
+        ofstream file(temp_file, ios::binary);
+        if (file.is_open()) {
+            size_t size = experience.size();
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            
+            for (const auto& entry : experience) {
+                // ذخیره کلید
+                size_t key_size = entry.first.size();
+                file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+                file.write(entry.first.c_str(), key_size);
+                
+                // ذخیره مقدار
+                file.write(reinterpret_cast<const char*>(&entry.second.first), sizeof(double));
+                
+                // ذخیره حرکت (ساده شده)
+                const Move& m = entry.second.second;
+                file.write(reinterpret_cast<const char*>(&m.from.row), sizeof(int));
+                file.write(reinterpret_cast<const char*>(&m.from.col), sizeof(int));
+                Position to_pos = m.to.empty() ? Position() : m.to.back();
+                file.write(reinterpret_cast<const char*>(&to_pos.row), sizeof(int));
+                file.write(reinterpret_cast<const char*>(&to_pos.col), sizeof(int));
+            }
+            file.close();
+#ifndef CHECKERS_HAVE_PROCESSES
+            remove(experience_file.c_str());   // rename در Windows مقصد موجود را جایگزین نمی‌کند
+#endif
+            if (!file || rename(temp_file.c_str(), experience_file.c_str()) != 0) {
+                remove(temp_file.c_str());
+            }
+        }
+    }
+    
+    // بارگذاری تجربیات
+    void loadExperience() {
+        TraceSpan span("loadExperience", "io");
+        ifstream file(experience_file, ios::binary);
+        if (file.is_open()) {
+            size_t size;
+            file.read(reinterpret_cast<char*>(&size), sizeof(size));
+            
+            for (size_t i = 0; i < size; i++) {
+                // خواندن کلید
+                size_t key_size;
+                file.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+                string key(key_size, ' ');
+                file.read(&key[0], key_size);
+                
+                // خواندن مقدار
+                double value;
+                file.read(reinterpret_cast<char*>(&value), sizeof(double));
+                
+                // خواندن حرکت
+                Move m;
+                file.read(reinterpret_cast<char*>(&m.from.row), sizeof(int));
+                file.read(reinterpret_cast<char*>(&m.from.col), sizeof(int));
+                Position to_pos;
+                file.read(reinterpret_cast<char*>(&to_pos.row), sizeof(int));
+                file.read(reinterpret_cast<char*>(&to_pos.col), sizeof(int));
+                m.to.push_back(to_pos);
+                
+                experience[key] = make_pair(value, m);
+            }
+            file.close();
+        }
+    }
+};
+
+// ============================================================================
+// عامل Monte Carlo Tree Search
+// ============================================================================
+
+class MCTSAgent : public CheckersAgent {
+private:
+    // گره درخت؛ فرزندان هر گره به صورت پیوسته در arena قرار دارند
+    struct Node {
+        Move move;                      // حرکتی که به این گره منجر شده
+        PieceType mover = PieceType::EMPTY;  // بازیکنی که move را انجام داده
+        int parent = -1;
+        int first_child = -1;
+        int num_children = 0;
+        bool expanded = false;
+        int visits = 0;
+        int virtual_loss = 0;
+        double wins = 0.0;              // از دید mover (تساوی = 0.5)
+    };
+
+    vector<Node> arena;
+    CheckersGame root_game;
+    bool has_tree = false;
+
+    int max_playouts;       // بودجه تعداد شبیه‌سازی (0 = بدون محدودیت)
+    int time_limit_ms;      // بودجه زمانی (0 = بدون محدودیت)
+    int num_threads;
+    string rollout_policy;  // "random" یا "greedy"
+    double exploration;
+    size_t max_nodes;
+    int max_rollout_plies = 150;
+
+    mutex tree_mutex;
+    int playouts_done = 0;
+    int reused_nodes = 0;
+    
+    // هر جستجو و هر نخ جریان تصادفی جداگانه‌ای از این بذر دارد
+    uint64_t seed;
+    uint64_t search_count = 0;
+    
+    // توقف خارجی جستجوی جاری (getMove با StopToken)
+    const atomic<bool>* stop_flag = nullptr;
+
+    static PieceType opponentOf(PieceType p) {
+        return (p == PieceType::BLACK_PIECE) ? PieceType::WHITE_PIECE : PieceType::BLACK_PIECE;
+    }
+
+    // امتیاز نتیجه از دید بازیکن
+    static double rewardFor(PieceType winner, PieceType who) {
+        if (winner == PieceType::EMPTY) return 0.5;
+        return winner == who ? 1.0 : 0.0;
+    }
+
+    int newNode(const Move& move, PieceType mover, int parent) {
+        Node node;
+        node.move = move;
+        node.mover = mover;
+        node.parent = parent;
+        arena.push_back(node);
+        return arena.size() - 1;
+    }
+
+    // انتخاب فرزند با UCT؛ virtual loss مسیرهای در حال شبیه‌سازی را کم‌ارزش می‌کند
+    int selectChild(int index) const {
+        const Node& node = arena[index];
+        double log_parent = log(max(1, node.visits + node.virtual_loss));
+        int best = -1;
+        double best_score = -numeric_limits<double>::infinity();
+
+        for (int c = node.first_child; c < node.first_child + node.num_children; c++) {
+            const Node& child = arena[c];
+            int n = child.visits + child.virtual_loss;
+            double score;
+            if (n == 0) {
+                score = numeric_limits<double>::infinity();
+            } else {
+                score = child.wins / n + exploration * sqrt(log_parent / n);
+            }
+            if (score > best_score) {
+                best_score = score;
+                best = c;
+            }
+        }
+        return best;
+    }
+
+    // شبیه‌سازی تا پایان بازی با سیاست RandomAgent/GreedyAgent
+    PieceType rollout(CheckersGame& state, CheckersAgent& black_policy,
+                      CheckersAgent& white_policy) const {
+        int plies = 0;
+        while (!state.isGameOver() && plies < max_rollout_plies) {
+            CheckersAgent& policy = (state.getCurrentPlayer() == PieceType::BLACK_PIECE) ?
+                                    black_policy : white_policy;
+            Move move = policy.getMove(state);
+            if (move.to.empty()) {
+                return opponentOf(state.getCurrentPlayer());
+            }
+            state.applyMove(move);
+            plies++;
+        }
+        return state.isGameOver() ? state.getWinner() : PieceType::EMPTY;
+    }
+
+    unique_ptr<CheckersAgent> makePolicy(PieceType p, uint64_t stream_seed) const {
+        if (rollout_policy == "greedy") {
+            return make_unique<GreedyAgent>(p);
+        }
+        return make_unique<RandomAgent>(p, stream_seed);
+    }
+
+    // یک شبیه‌سازی: انتخاب و گسترش زیر قفل، rollout بدون قفل، سپس پس‌انتشار
+    bool runPlayout(CheckersAgent& black_policy, CheckersAgent& white_policy) {
+        vector<int> path;
+        CheckersGame state = root_game.copy();
+
+        {
+            lock_guard<mutex> lock(tree_mutex);
+            int index = 0;
+            path.push_back(index);
+            arena[index].virtual_loss++;
+
+            while (arena[index].expanded && arena[index].num_children > 0) {
+                index = selectChild(index);
+                state.applyMove(arena[index].move);
+                arena[index].virtual_loss++;
+                path.push_back(index);
+            }
+
+            if (!arena[index].expanded && !state.isGameOver()) {
+                vector<Move> moves = state.getAllValidMoves(state.getCurrentPlayer());
+                if (arena.size() + moves.size() <= max_nodes && !moves.empty()) {
+                    PieceType mover = state.getCurrentPlayer();
+                    int first = arena.size();
+                    for (const auto& move : moves) {
+                        newNode(move, mover, index);
+                    }
+                    arena[index].first_child = first;
+                    arena[index].num_children = moves.size();
+                    arena[index].expanded = true;
+
+                    index = selectChild(index);
+                    state.applyMove(arena[index].move);
+                    arena[index].virtual_loss++;
+                    path.push_back(index);
+                } else if (path.size() == 1 && arena[index].num_children == 0) {
+                    // arena پر است و ریشه گسترش نیافته
+                    arena[index].virtual_loss--;
+                    return false;
+                }
+            }
+        }
+
+        PieceType winner = rollout(state, black_policy, white_policy);
+
+        lock_guard<mutex> lock(tree_mutex);
+        for (int index : path) {
+            Node& node = arena[index];
+            node.virtual_loss--;
+            node.visits++;
+            node.wins += rewardFor(winner, node.mover);
+        }
+        playouts_done++;
+        return true;
+    }
+
+    // استفاده مجدد از زیردرخت: جستجوی موقعیت فعلی تا دو لایه زیر ریشه قبلی
+    int findReusableRoot(const CheckersGame& game) const {
+        if (!has_tree || arena.empty()) {
+            return -1;
+        }
+        string key = game.getBoardKey();
+        if (root_game.getBoardKey() == key && root_game.getCurrentPlayer() == game.getCurrentPlayer()) {
+            return 0;
+        }
+
+        const Node& root = arena[0];
+        for (int c = root.first_child; c < root.first_child + root.num_children; c++) {
+            CheckersGame after_child = root_game.copy();
+            after_child.applyMove(arena[c].move);
+            if (after_child.getBoardKey() == key && after_child.getCurrentPlayer() == game.getCurrentPlayer()) {
+                return c;
+            }
+
+            const Node& child = arena[c];
+            for (int g = child.first_child; g < child.first_child + child.num_children; g++) {
+                CheckersGame after_grandchild = after_child.copy();
+                after_grandchild.applyMove(arena[g].move);
+                if (after_grandchild.getBoardKey() == key &&
+                    after_grandchild.getCurrentPlayer() == game.getCurrentPlayer()) {
+                    return g;
+                }
+            }
+        }
+        return -1;
+    }
+
+    // فشرده‌سازی زیردرخت new_root در ابتدای یک arena جدید
+    void rerootArena(int new_root) {
+        vector<Node> compacted;
+        compacted.reserve(arena.size());
+        compacted.push_back(arena[new_root]);
+        compacted[0].parent = -1;
+
+        // پیمایش سطحی؛ فرزندان هر گره پیوسته کپی می‌شوند
+        vector<int> source_of = {new_root};
+        for (size_t i = 0; i < compacted.size(); i++) {
+            const Node& old_node = arena[source_of[i]];
+            if (old_node.num_children == 0) continue;
+
+            int first = compacted.size();
+            for (int c = old_node.first_child; c < old_node.first_child + old_node.num_children; c++) {
+                compacted.push_back(arena[c]);
+                compacted.back().parent = i;
+                source_of.push_back(c);
+            }
+            compacted[i].first_child = first;
+        }
+
+        arena.swap(compacted);
+    }
+
+public:
+    MCTSAgent(PieceType p, int playouts = 2000, int time_ms = 0, int threads = 0,
+              string policy = "random", double c = 1.41, size_t node_limit = 1000000,
+              uint64_t s = 1)
+        : CheckersAgent(p, "MCTS Agent"), max_playouts(playouts), time_limit_ms(time_ms),
+          num_threads(threads), rollout_policy(policy), exploration(c), max_nodes(node_limit),
+          seed(s) {
+        if (num_threads <= 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+        if (max_playouts <= 0 && time_limit_ms <= 0) {
+            max_playouts = 2000;
+        }
+        name = "MCTS (n=" + to_string(max_playouts) + ", t=" + to_string(time_limit_ms) +
+               "ms, " + rollout_policy + ")";
+        arena.reserve(min<size_t>(max_nodes, 1 << 16));
+    }
+
+    Move getMove(const CheckersGame& game) override {
+        vector<Move> moves = game.getAllValidMoves(player);
+        if (moves.empty()) {
+            return Move();
+        }
+        if (moves.size() == 1) {
+            return moves[0];
+        }
+
+        // استفاده مجدد از درخت حرکت قبلی یا شروع درخت جدید
+        int reuse = findReusableRoot(game);
+        if (reuse > 0) {
+            rerootArena(reuse);
+        } else if (reuse < 0) {
+            arena.clear();
+            newNode(Move(), opponentOf(player), -1);
+        }
+        reused_nodes = arena.size() - 1;
+        root_game = game.copy();
+        has_tree = true;
+        playouts_done = 0;
+
+        auto start = chrono::steady_clock::now();
+        atomic<int> started(0);
+        atomic<bool> arena_full(false);
+
+        search_count++;
+        auto worker = [&](int thread_id) {
+            uint64_t stream = (search_count * 1024 + thread_id) * 2;
+            unique_ptr<CheckersAgent> black_policy = makePolicy(PieceType::BLACK_PIECE,
+                                                                deriveSeed(seed, stream));
+            unique_ptr<CheckersAgent> white_policy = makePolicy(PieceType::WHITE_PIECE,
+                                                                deriveSeed(seed, stream + 1));
+
+            while (!arena_full) {
+                if (stop_flag != nullptr && stop_flag->load(memory_order_relaxed)) {
+                    break;
+                }
+                if (max_playouts > 0 && started.fetch_add(1) >= max_playouts) {
+                    break;
+                }
+                if (time_limit_ms > 0) {
+                    auto elapsed = chrono::duration_cast<chrono::milliseconds>(
+                        chrono::steady_clock::now() - start).count();
+                    if (elapsed >= time_limit_ms) {
+                        break;
+                    }
+                }
+                if (!runPlayout(*black_policy, *white_policy)) {
+                    arena_full = true;
+                }
+            }
+        };
+
+        vector<thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            workers.emplace_back(worker, t);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        // انتخاب پربازدیدترین فرزند ریشه
+        const Node& root = arena[0];
+        if (root.num_children == 0) {
+            return moves[0];
+        }
+        int best = root.first_child;
+        for (int c = root.first_child; c < root.first_child + root.num_children; c++) {
+            if (arena[c].visits > arena[best].visits) {
+                best = c;
+            }
+        }
+
+        // برگرداندن نسخه معتبر حرکت از لیست حرکات فعلی
+        for (const auto& move : moves) {
+            if (move.from == arena[best].move.from && move.to == arena[best].move.to) {
+                return move;
+            }
+        }
+        return arena[best].move;
+    }
+
+    // نسخه قابل توقف: شبیه‌سازی‌ها تا پایان بودجه یا درخواست توقف
+    Move getMove(const CheckersGame& game, const StopToken& stop) override {
+        stop_flag = stop.get();
+        Move move = getMove(game);
+        stop_flag = nullptr;
+        return move;
+    }
+    
+    int getPlayoutCount() const { return playouts_done; }
+    int getTreeSize() const { return arena.size(); }
+    int getReusedNodes() const { return reused_nodes; }
+};
+
+// ============================================================================
+// آموزش TD(λ) با بازی خودی و به‌روزرسانی دسته‌ای موازی
+// ============================================================================
+
+class TDLambdaTrainer {
+private:
+    LinearEvaluator& evaluator;
+    double alpha;        // نرخ یادگیری
+    double lambda;       // ضریب ردپای شایستگی
+    double epsilon;      // احتمال حرکت اکتشافی
+    int num_threads;
+    uint64_t seed;
+
+    using Features = LinearEvaluator::Features;
+
+    // نتیجه یک بازی خودی
+    struct GameOutcome {
+        double result = 0.0;   // از دید سیاه
+        int plies = 0;
+    };
+
+    // انتخاب حرکت حریصانه یک لایه‌ای با وزن‌های ثابت دسته
+    Move chooseMove(const CheckersGame& game, const vector<Move>& moves, Xoshiro256& rng) const {
+        if (rng.nextDouble() < epsilon) {
+            return moves[rng.below(moves.size())];
+        }
+
+        PieceType mover = game.getCurrentPlayer();
+        const Move* best_move = &moves[0];
+        double best_value = -numeric_limits<double>::infinity();
+
+        for (const auto& move : moves) {
+            CheckersGame next = game.copy();
+            next.applyMove(move);
+
+            double value;
+            if (next.isGameOver()) {
+                PieceType winner = next.getWinner();
+                value = (winner == mover) ? 1.0 : (winner == PieceType::EMPTY ? 0.0 : -1.0);
+            } else {
+                value = evaluator.value(evaluator.extractFeatures(next, mover));
+            }
+
+            if (value > best_value) {
+                best_value = value;
+                best_move = &move;
+            }
+        }
+        return *best_move;
+    }
+
+    // یک بازی خودی کامل؛ تغییرات وزن در delta جمع می‌شود
+    GameOutcome playAndAccumulate(Xoshiro256& rng, Features& delta) const {
+        GameOutcome outcome;
+        CheckersGame game;
+
+        Features trace;
+        trace.fill(0.0);
+
+        // ویژگی‌ها همیشه از دید سیاه محاسبه می‌شوند
+        Features features = evaluator.extractFeatures(game, PieceType::BLACK_PIECE);
+        double value = evaluator.value(features);
+
+        while (!game.isGameOver()) {
+            vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+            if (moves.empty()) {
+                break;
+            }
+
+            game.applyMove(chooseMove(game, moves, rng));
+            outcome.plies++;
+
+            // ردپا: e = λe + ∇V
+            double grad_scale = LinearEvaluator::VALUE_SCALE * (1.0 - value * value);
+            for (int k = 0; k < LinearEvaluator::NUM_FEATURES; k++) {
+                trace[k] = lambda * trace[k] + grad_scale * features[k];
+            }
+
+            double next_value;
+            Features next_features{};
+            if (game.isGameOver()) {
+                PieceType winner = game.getWinner();
+                next_value = (winner == PieceType::BLACK_PIECE) ? 1.0 :
+                             (winner == PieceType::WHITE_PIECE ? -1.0 : 0.0);
+                outcome.result = next_value;
+            } else {
+                next_features = evaluator.extractFeatures(game, PieceType::BLACK_PIECE);
+                next_value = evaluator.value(next_features);
+            }
+
+            double td_error = next_value - value;
+            for (int k = 0; k < LinearEvaluator::NUM_FEATURES; k++) {
+                delta[k] += alpha * td_error * trace[k];
+            }
+
+            features = next_features;
+            value = next_value;
+        }
+
+        return outcome;
+    }
+
+public:
+    TDLambdaTrainer(LinearEvaluator& eval, double a = 0.01, double l = 0.7,
+                    double eps = 0.1, int threads = 0, uint64_t s = 1)
+        : evaluator(eval), alpha(a), lambda(l), epsilon(eps), num_threads(threads), seed(s) {
+        if (num_threads <= 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+    }
+
+    // اجرای یک دسته: بازی‌ها با وزن‌های ثابت به صورت موازی، سپس یک به‌روزرسانی
+    // هر بازی جریان تصادفی و delta خودش را دارد؛ جمع به ترتیب بازی‌ها انجام می‌شود
+    // تا نتیجه به تعداد نخ‌ها و زمان‌بندی آن‌ها وابسته نباشد
+    void trainBatch(int batch_index, int games_per_batch) {
+        vector<Features> deltas(games_per_batch);
+        vector<GameOutcome> outcomes(games_per_batch);
+        atomic<int> next_game(0);
+
+        auto worker = [&]() {
+            int game_index;
+            while ((game_index = next_game.fetch_add(1)) < games_per_batch) {
+                Xoshiro256 rng(deriveSeed(seed, static_cast<uint64_t>(batch_index) * games_per_batch + game_index));
+                deltas[game_index].fill(0.0);
+                outcomes[game_index] = playAndAccumulate(rng, deltas[game_index]);
+            }
+        };
+
+        vector<thread> workers;
+        int thread_count = min(num_threads, max(1, games_per_batch));
+        for (int t = 0; t < thread_count; t++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        // میانگین تغییرات همه بازی‌های دسته، به ترتیب اندیس بازی
+        auto& weights = evaluator.getWeights();
+        Features batch_delta;
+        batch_delta.fill(0.0);
+        double total_result = 0.0;
+        long long total_plies = 0;
+        for (int g = 0; g < games_per_batch; g++) {
+            for (int k = 0; k < LinearEvaluator::NUM_FEATURES; k++) {
+                batch_delta[k] += deltas[g][k];
+            }
+            total_result += outcomes[g].result;
+            total_plies += outcomes[g].plies;
+        }
+        for (int k = 0; k < LinearEvaluator::NUM_FEATURES; k++) {
+            weights[k] += batch_delta[k] / games_per_batch;
+        }
+
+        cout << "batch " << batch_index + 1 << ": games=" << games_per_batch
+             << " avg_plies=" << static_cast<double>(total_plies) / games_per_batch
+             << " black_score=" << total_result / games_per_batch
+             << " men=" << weights[LinearEvaluator::F_MEN]
+             << " kings=" << weights[LinearEvaluator::F_KINGS] << endl;
+    }
+
+    void train(int num_batches, int games_per_batch, const string& weights_file) {
+        cout << "TD(lambda) training: threads=" << num_threads << " alpha=" << alpha
+             << " lambda=" << lambda << " epsilon=" << epsilon << " seed=" << seed << endl;
+
+        for (int b = 0; b < num_batches; b++) {
+            trainBatch(b, games_per_batch);
+        }
+
+        if (evaluator.saveWeights(weights_file)) {
+            cout << "weights saved to " << weights_file << endl;
+        } else {
+            cout << "cannot write " << weights_file << endl;
+        }
+    }
+};
+
+// ============================================================================
+// داده بازی خودی: خروجی جریانی با نخ نویسنده پس‌زمینه
+// ============================================================================
+
+// یک رکورد 16 بایتی برای هر موقعیت؛ امتیاز و نتیجه از دید بازیکن در نوبت
+struct SelfPlayRecord {
+    uint64_t position = 0;      // CheckersGame::pack()
+    int16_t score = 0;          // صدم مهره؛ ±30000 برای برد/باخت قطعی
+    uint8_t move_index = 0;     // اندیس بهترین حرکت در getAllValidMoves
+    uint8_t from_square = 0;    // شماره خانه‌های مبدأ و مقصد نهایی (1..18)
+    uint8_t to_square = 0;
+    int8_t result = 0;          // 1 برد، 0 مساوی، -1 باخت
+    uint8_t depth = 0;
+    uint8_t ply = 0;            // نیم‌حرکت (حداکثر 255)
+};
+
+// قالب فایل: "CKSP" + نسخه، سپس قطعه‌ها: "CHNK" + تعداد (uint32) + رکوردها
+const char SELFPLAY_FILE_MAGIC[4] = {'C', 'K', 'S', 'P'};
+const char SELFPLAY_CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+const uint32_t SELFPLAY_FILE_VERSION = 1;
+const size_t SELFPLAY_RECORD_BYTES = 16;
+
+inline void encodeRecord(const SelfPlayRecord& record, unsigned char* out) {
+    storeLE64(out, record.position);
+    uint16_t score = static_cast<uint16_t>(record.score);
+    out[8] = score & 0xFF;
+    out[9] = score >> 8;
+    out[10] = record.move_index;
+    out[11] = record.from_square;
+    out[12] = record.to_square;
+    out[13] = static_cast<uint8_t>(record.result);
+    out[14] = record.depth;
+    out[15] = record.ply;
+}
+
+inline SelfPlayRecord decodeRecord(const unsigned char* in) {
+    SelfPlayRecord record;
+    record.position = loadLE64(in);
+    record.score = static_cast<int16_t>(in[8] | (in[9] << 8));
+    record.move_index = in[10];
+    record.from_square = in[11];
+    record.to_square = in[12];
+    record.result = static_cast<int8_t>(in[13]);
+    record.depth = in[14];
+    record.ply = in[15];
+    return record;
+}
+
+// نخ‌های بازی رکوردهای هر بازی را یکجا تحویل می‌دهند و فقط برای الحاق قفل می‌گیرند؛
+// قطعه‌های پر در صف می‌روند و نخ نویسنده آن‌ها را روی دیسک می‌نویسد
+class DatasetWriter {
+private:
+    static const size_t CHUNK_RECORDS = 4096;
+    
+    ofstream file;
+    mutex queue_mutex;
+    condition_variable queue_ready;
+    vector<SelfPlayRecord> current;
+    deque<vector<SelfPlayRecord>> queue;
+    bool closing = false;
+    thread writer;
+    
+    // فقط در نخ نویسنده
+    vector<unsigned char> bytes;
+    size_t records_written = 0;
+    size_t chunks_written = 0;
+    size_t max_queue = 0;
+    
+    void writeChunk(const vector<SelfPlayRecord>& chunk) {
+        bytes.resize(8 + chunk.size() * SELFPLAY_RECORD_BYTES);
+        memcpy(bytes.data(), SELFPLAY_CHUNK_MAGIC, 4);
+        uint32_t count = chunk.size();
+        for (int b = 0; b < 4; b++) {
+            bytes[4 + b] = static_cast<unsigned char>(count >> (8 * b));
+        }
+        for (size_t i = 0; i < chunk.size(); i++) {
+            encodeRecord(chunk[i], &bytes[8 + i * SELFPLAY_RECORD_BYTES]);
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        records_written += chunk.size();
+        chunks_written++;
+    }
+    
+    void writerLoop() {
+        unique_lock<mutex> lock(queue_mutex);
+        while (true) {
+            queue_ready.wait(lock, [this]() { return closing || !queue.empty(); });
+            if (queue.empty()) {
+                break;   // closing و صف خالی
+            }
+            vector<SelfPlayRecord> chunk = move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            writeChunk(chunk);
+            lock.lock();
+        }
+    }
+    
+public:
+    explicit DatasetWriter(const string& filename) : file(filename, ios::binary) {
+        unsigned char header[8];
+        memcpy(header, SELFPLAY_FILE_MAGIC, 4);
+        for (int b = 0; b < 4; b++) {
+            header[4 + b] = static_cast<unsigned char>(SELFPLAY_FILE_VERSION >> (8 * b));
+        }
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        current.reserve(CHUNK_RECORDS);
+        writer = thread(&DatasetWriter::writerLoop, this);
+    }
+    
+    ~DatasetWriter() {
+        close();
+    }
+    
+    bool isOpen() const { return file.good(); }
+    
+    void submit(const vector<SelfPlayRecord>& records) {
+        lock_guard<mutex> lock(queue_mutex);
+        for (const auto& record : records) {
+            current.push_back(record);
+            if (current.size() == CHUNK_RECORDS) {
+                queue.push_back(move(current));
+                current = vector<SelfPlayRecord>();
+                current.reserve(CHUNK_RECORDS);
+                max_queue = max(max_queue, queue.size());
+                queue_ready.notify_one();
+            }
+        }
+    }
+    
+    // تخلیه قطعه ناقص، پایان نخ نویسنده و بستن فایل
+    void close() {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            if (closing) {
+                return;
+            }
+            if (!current.empty()) {
+                queue.push_back(move(current));
+                current = vector<SelfPlayRecord>();
+            }
+            closing = true;
+        }
+        queue_ready.notify_one();
+        writer.join();
+        file.flush();
+    }
+    
+    // پس از close معتبرند
+    size_t recordsWritten() const { return records_written; }
+    size_t chunksWritten() const { return chunks_written; }
+    size_t maxQueuedChunks() const { return max_queue; }
+};
+
+// خواندن قطعه به قطعه؛ on_record(const SelfPlayRecord&) برای هر رکورد
+template<class Callback>
+size_t readSelfPlayDataset(const string& filename, Callback&& on_record) {
+    ifstream file(filename, ios::binary);
+    unsigned char header[8];
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || memcmp(header, SELFPLAY_FILE_MAGIC, 4) != 0 || header[4] != SELFPLAY_FILE_VERSION) {
+        return 0;
+    }
+    
+    vector<unsigned char> chunk;
+    size_t total = 0;
+    unsigned char chunk_header[8];
+    while (file.read(reinterpret_cast<char*>(chunk_header), sizeof(chunk_header))) {
+        if (memcmp(chunk_header, SELFPLAY_CHUNK_MAGIC, 4) != 0) {
+            break;
+        }
+        uint32_t count = chunk_header[4] | (chunk_header[5] << 8) | (chunk_header[6] << 16) |
+                         (uint32_t(chunk_header[7]) << 24);
+        chunk.resize(count * SELFPLAY_RECORD_BYTES);
+        if (!file.read(reinterpret_cast<char*>(chunk.data()), chunk.size())) {
+            break;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            on_record(decodeRecord(&chunk[i * SELFPLAY_RECORD_BYTES]));
+        }
+        total += count;
+    }
+    return total;
+}
+
+// بازی خودی موازی: هر موقعیت با امتیاز و بهترین حرکت جستجو ثبت می‌شود.
+// هر بازی عامل‌ها (و جدول جابجایی) تازه دارد تا داده مستقل از تعداد نخ‌ها باشد.
+class SelfPlayGenerator {
+private:
+    int num_games;
+    int num_threads;
+    int depth;
+    string eval_name;
+    int random_plies;       // حرکات تصادفی ابتدای هر بازی (تنوع)
+    double epsilon;         // احتمال بازی حرکت تصادفی به جای بهترین حرکت
+    int max_plies;
+    uint64_t seed;
+    
+    static int16_t scoreToCenti(double score) {
+        if (score >= 1000.0) return 30000;
+        if (score <= -1000.0) return -30000;
+        return static_cast<int16_t>(max(-29999.0, min(29999.0, round(score * 100.0))));
+    }
+    
+    void playGame(int game_index, vector<SelfPlayRecord>& records) {
+        Xoshiro256 rng(deriveSeed(seed, game_index));
+        array<unique_ptr<MinimaxAgent>, 2> agents = {
+            make_unique<MinimaxAgent>(PieceType::BLACK_PIECE, depth, true, eval_name),
+            make_unique<MinimaxAgent>(PieceType::WHITE_PIECE, depth, true, eval_name)};
+        CheckersGame game;
+        records.clear();
+        
+        for (int ply = 0; ply < random_plies && !game.isGameOver(); ply++) {
+            vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+            game.applyMove(moves[rng.below(moves.size())]);
+        }
+        
+        SearchLimits limits;
+        limits.depth = depth;
+        while (!game.isGameOver() && static_cast<int>(game.getMoveHistory().size()) < max_plies) {
+            PieceType side = game.getCurrentPlayer();
+            vector<Move> moves = game.getAllValidMoves(side);
+            
+            double score = 0.0;
+            MinimaxAgent& agent = *agents[side == PieceType::BLACK_PIECE ? 0 : 1];
+            Move best = agent.searchIterative(game, limits, [&score](const SearchInfo& info) {
+                score = info.score;
+            });
+            
+            size_t best_index = 0;
+            for (size_t i = 0; i < moves.size(); i++) {
+                if (moves[i].from == best.from && moves[i].to == best.to) {
+                    best_index = i;
+                    break;
+                }
+            }
+            
+            SelfPlayRecord record;
+            record.position = game.pack();
+            record.score = scoreToCenti(score);
+            record.move_index = static_cast<uint8_t>(best_index);
+            record.from_square = CheckersGame::squareNumber(best.from.row, best.from.col);
+            record.to_square = CheckersGame::squareNumber(best.to.back().row, best.to.back().col);
+            record.depth = static_cast<uint8_t>(depth);
+            record.ply = static_cast<uint8_t>(min<size_t>(game.getMoveHistory().size(), 255));
+            record.result = (side == PieceType::BLACK_PIECE) ? 1 : -1;   // علامت رنگ تا پایان بازی
+            records.push_back(record);
+            
+            const Move& played = (rng.nextDouble() < epsilon) ? moves[rng.below(moves.size())]
+                                                              : moves[best_index];
+            game.applyMove(played);
+        }
+        
+        // نتیجه از دید بازیکن در نوبت هر موقعیت
+        int black_result = 0;
+        if (game.getWinner() == PieceType::BLACK_PIECE) black_result = 1;
+        else if (game.getWinner() == PieceType::WHITE_PIECE) black_result = -1;
+        for (auto& record : records) {
+            record.result = static_cast<int8_t>(record.result * black_result);
+        }
+    }
+    
+public:
+    SelfPlayGenerator(int games, int threads = 0, int d = 4, string eval = "advanced",
+                      int opening_plies = 4, double eps = 0.05, int plies = 200, uint64_t s = 1)
+        : num_games(games), num_threads(threads), depth(d), eval_name(eval),
+          random_plies(opening_plies), epsilon(eps), max_plies(plies), seed(s) {
+        if (num_threads <= 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+    }
+    
+    // بازی‌ها به ترتیب شماره به نویسنده داده می‌شوند (مانند BatchAnalyzer::run)،
+    // پس فایل خروجی به تعداد نخ‌ها و ترتیب پایان بازی‌ها وابسته نیست
+    void run(DatasetWriter& writer) {
+        atomic<int> next_game(0);
+        atomic<long long> positions(0);
+        mutex submit_mutex;
+        map<int, vector<SelfPlayRecord>> pending;
+        int next_submit = 0;
+        auto start = chrono::steady_clock::now();
+        
+        auto worker = [&]() {
+            int game_index;
+            while ((game_index = next_game.fetch_add(1)) < num_games) {
+                vector<SelfPlayRecord> records;
+                playGame(game_index, records);
+                positions += records.size();
+                
+                lock_guard<mutex> lock(submit_mutex);
+                pending.emplace(game_index, move(records));
+                while (!pending.empty() && pending.begin()->first == next_submit) {
+                    writer.submit(pending.begin()->second);
+                    pending.erase(pending.begin());
+                    next_submit++;
+                }
+            }
+        };
+        
+        vector<thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        double search_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        writer.close();
+        double total_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        cout << "self-play: games=" << num_games << " threads=" << num_threads << " depth=" << depth
+             << " eval=" << eval_name << " seed=" << seed << endl;
+        cout << "positions: " << positions << " in " << search_seconds << "s ("
+             << static_cast<long long>(positions / max(search_seconds, 1e-9)) << " positions/s), "
+             << "writer drained " << (total_seconds - search_seconds) * 1000.0 << "ms after play" << endl;
+        cout << "chunks: " << writer.chunksWritten() << ", max queued chunks: "
+             << writer.maxQueuedChunks() << endl;
+    }
+};
+
+// ============================================================================
+// تیونر Texel برای پارامترهای ارزیاب دستی
+// ============================================================================
+
+// هسته‌های تیونر Texel: y += a * x و sum(x * y) (جمع جزئی float، جمع کل double)
+void texelAxpyScalar(float* y, const float* x, float a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+double texelDotScalar(const float* x, const float* y, size_t n) {
+    float partial = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        partial += x[i] * y[i];
+    }
+    return partial;
+}
+
+#if defined(__SSE2__)
+void texelAxpySse2(float* y, const float* x, float a, size_t n) {
+    size_t i = 0;
+    __m128 va = _mm_set1_ps(a);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+    }
+    texelAxpyScalar(y + i, x + i, a, n - i);
+}
+
+double texelDotSse2(const float* x, const float* y, size_t n) {
+    size_t i = 0;
+    __m128 sum = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, sum);
+    float partial = 0.0f;
+    for (float lane : lanes) partial += lane;
+    return partial + texelDotScalar(x + i, y + i, n - i);
+}
+#endif
+
+#ifdef CHECKERS_X86
+CHECKERS_TARGET("avx2") void texelAxpyAvx2(float* y, const float* x, float a, size_t n) {
+    size_t i = 0;
+    __m256 va = _mm256_set1_ps(a);
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+    }
+    texelAxpyScalar(y + i, x + i, a, n - i);
+}
+
+CHECKERS_TARGET("avx2") double texelDotAvx2(const float* x, const float* y, size_t n) {
+    size_t i = 0;
+    __m256 sum = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, sum);
+    float partial = 0.0f;
+    for (float lane : lanes) partial += lane;
+    return partial + texelDotScalar(x + i, y + i, n - i);
+}
+#endif
+
+// کمینه‌سازی میانگین (t - sigmoid(K * eval))^2 روی نتایج بازی‌ها. ارزیاب‌های
+// دستی در EvalParams خطی‌اند، پس ویژگی هر موقعیت یک بار حساب و ستونی (SoA)
+// ذخیره می‌شود؛ گرادیان با هسته‌های برداری روی تکه‌های داده در چند نخ جمع می‌شود.
+class TexelTuner {
+private:
+    int num_threads;
+    vector<int> active;                     // پارامترهایی که ارزیاب انتخابی می‌خواند
+    vector<vector<float>> columns;          // columns[a][i]: ویژگی active[a] موقعیت i
+    vector<float> targets;                  // (نتیجه + 1) / 2 از دید بازیکن در نوبت
+    
+    static constexpr size_t BLOCK = 4096;
+    
+    // ویژگی‌های خطی از دید player؛ eval = sum(values[k] * features[k])
+    static array<float, EvalParams::COUNT> extractFeatures(const CheckersGame& game, PieceType player) {
+        array<float, EvalParams::COUNT> f{};
+        const auto& board = game.getBoard();
+        for (int square = 1; square <= CheckersGame::SQUARES; square++) {
+            Position pos = CheckersGame::squarePosition(square);
+            PieceType piece = board[pos.row][pos.col];
+            PieceType color = game.getPieceColor(piece);
+            if (color == PieceType::EMPTY) {
+                continue;
+            }
+            float sign = (color == player) ? 1.0f : -1.0f;
+            f[game.isKing(piece) ? EvalParams::KING : EvalParams::MAN] += sign;
+            f[EvalParams::FIRST_SQUARE + square - 1] += sign;
+            if (color == player) {
+                if (!game.isKing(piece)) {
+                    f[EvalParams::ADVANCEMENT] += (player == PieceType::BLACK_PIECE)
+                        ? pos.row : (CheckersGame::SIZE - 1 - pos.row);
+                }
+                bool edge = pos.col == 0 || pos.col == CheckersGame::SIZE - 1;
+                f[edge ? EvalParams::EDGE_PENALTY : EvalParams::CENTER_BONUS] += edge ? -1.0f : 1.0f;
+            }
+        }
+        return f;
+    }
+    
+    // اجرای fn(begin, end) روی تکه‌های داده در نخ‌ها
+    template<class Fn>
+    void parallelBlocks(Fn&& fn) const {
+        const size_t n = targets.size();
+        const size_t per_thread = (n + num_threads - 1) / num_threads;
+        vector<thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            size_t begin = min(n, t * per_thread);
+            size_t end = min(n, begin + per_thread);
+            workers.emplace_back([&fn, t, begin, end]() { fn(t, begin, end); });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    
+    // ارزیابی یک بلوک با پارامترهای فعال
+    void evaluateBlock(const vector<double>& weights, size_t begin, size_t n, float* eval) const {
+        fill(eval, eval + n, 0.0f);
+        for (size_t a = 0; a < active.size(); a++) {
+            kernels().axpy(eval, columns[a].data() + begin, static_cast<float>(weights[a]), n);
+        }
+    }
+    
+    static double sigmoid(double x) { return 1.0 / (1.0 + exp(-x)); }
+    
+public:
+    // eval_name: مجموعه پارامترهایی که ارزیاب مربوط استفاده می‌کند
+    TexelTuner(int threads = 0, const string& eval_name = "advanced") : num_threads(threads) {
+        if (num_threads <= 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+        active = {EvalParams::MAN, EvalParams::KING};
+        if (eval_name == "advanced") {
+            active.push_back(EvalParams::ADVANCEMENT);
+            for (int k = 0; k < EvalParams::SQUARES; k++) {
+                active.push_back(EvalParams::FIRST_SQUARE + k);
+            }
+        } else if (eval_name == "positional") {
+            active.push_back(EvalParams::CENTER_BONUS);
+            active.push_back(EvalParams::EDGE_PENALTY);
+        }
+        columns.resize(active.size());
+    }
+    
+    // result: +1 بُرد، 0 مساوی، -1 باخت برای بازیکن در نوبت
+    void addPosition(const CheckersGame& game, int result) {
+        auto f = extractFeatures(game, game.getCurrentPlayer());
+        for (size_t a = 0; a < active.size(); a++) {
+            columns[a].push_back(f[active[a]]);
+        }
+        targets.push_back(0.5f * (result + 1));
+    }
+    
+    size_t size() const { return targets.size(); }
+    const vector<int>& activeParams() const { return active; }
+    int getThreads() const { return num_threads; }
+    
+    vector<double> activeWeights(const EvalParams& params) const {
+        vector<double> weights;
+        for (int k : active) weights.push_back(params.values[k]);
+        return weights;
+    }
+    
+    // میانگین مربع خطا با مقیاس K
+    double error(const EvalParams& params, double k) const {
+        vector<double> weights = activeWeights(params);
+        vector<double> sums(num_threads, 0.0);
+        parallelBlocks([&](int t, size_t begin, size_t end) {
+            vector<float> eval(BLOCK);
+            for (size_t b = begin; b < end; b += BLOCK) {
+                size_t n = min(BLOCK, end - b);
+                evaluateBlock(weights, b, n, eval.data());
+                for (size_t i = 0; i < n; i++) {
+                    double diff = targets[b + i] - sigmoid(k * eval[i]);
+                    sums[t] += diff * diff;
+                }
+            }
+        });
+        double total = 0.0;
+        for (double v : sums) total += v;
+        return targets.empty() ? 0.0 : total / targets.size();
+    }
+    
+    // K با جستجوی بخش طلایی در [0.05, 10]
+    double fitScale(const EvalParams& params) const {
+        double lo = 0.05, hi = 10.0;
+        const double ratio = (sqrt(5.0) - 1.0) / 2.0;
+        for (int iter = 0; iter < 40; iter++) {
+            double a = hi - ratio * (hi - lo);
+            double b = lo + ratio * (hi - lo);
+            if (error(params, a) < error(params, b)) hi = b; else lo = a;
+        }
+        return (lo + hi) / 2.0;
+    }
+    
+    // گرادیان خطا نسبت به پارامترهای فعال
+    vector<double> gradient(const EvalParams& params, double k) const {
+        vector<double> weights = activeWeights(params);
+        vector<vector<double>> partial(num_threads, vector<double>(active.size(), 0.0));
+        parallelBlocks([&](int t, size_t begin, size_t end) {
+            vector<float> eval(BLOCK), residual(BLOCK);
+            for (size_t b = begin; b < end; b += BLOCK) {
+                size_t n = min(BLOCK, end - b);
+                evaluateBlock(weights, b, n, eval.data());
+                for (size_t i = 0; i < n; i++) {
+                    double s = sigmoid(k * eval[i]);
+                    residual[i] = static_cast<float>((s - targets[b + i]) * s * (1.0 - s));
+                }
+                for (size_t a = 0; a < active.size(); a++) {
+                    partial[t][a] += kernels().dot(residual.data(), columns[a].data() + b, n);
+                }
+            }
+        });
+        vector<double> grad(active.size(), 0.0);
+        const double scale = targets.empty() ? 0.0 : 2.0 * k / targets.size();
+        for (const auto& p : partial) {
+            for (size_t a = 0; a < active.size(); a++) grad[a] += p[a] * scale;
+        }
+        return grad;
+    }
+    
+    // Adam روی پارامترهای فعال؛ on_iteration(iter, error) برای گزارش پیشرفت
+    EvalParams tune(EvalParams params, double k, int iterations, double learning_rate,
+                    const function<void(int, double)>& on_iteration = nullptr) const {
+        const double beta1 = 0.9, beta2 = 0.999, eps = 1e-8;
+        vector<double> m(active.size(), 0.0), v(active.size(), 0.0);
+        for (int iter = 1; iter <= iterations; iter++) {
+            vector<double> grad = gradient(params, k);
+            for (size_t a = 0; a < active.size(); a++) {
+                m[a] = beta1 * m[a] + (1 - beta1) * grad[a];
+                v[a] = beta2 * v[a] + (1 - beta2) * grad[a] * grad[a];
+                double m_hat = m[a] / (1 - pow(beta1, iter));
+                double v_hat = v[a] / (1 - pow(beta2, iter));
+                params.values[active[a]] -= learning_rate * m_hat / (sqrt(v_hat) + eps);
+            }
+            if (on_iteration && (iter % 10 == 0 || iter == iterations)) {
+                on_iteration(iter, error(params, k));
+            }
+        }
+        params.rebuildTable();
+        return params;
+    }
+};
+
+// ============================================================================
+// تحلیل دسته‌ای موازی موقعیت‌ها
+// ============================================================================
+
+struct BatchAnalysisItem {
+    size_t index = 0;                   // جایگاه در ورودی
+    uint64_t position = 0;              // pack()
+    AnalysisResult result;
+};
+
+// تحلیل موازی فهرستی از موقعیت‌های فشرده (برچسب‌زنی، کتاب شروع، آزمون‌های
+// رگرسیون). هر نخ عامل خودش را دارد و جدول جابجایی پیش از هر موقعیت پاک
+// می‌شود تا نتیجه مستقل از تعداد نخ‌ها باشد. نتایج به ترتیب ورودی پخش می‌شوند.
+class BatchAnalyzer {
+private:
+    int num_threads;
+    int multipv;
+    SearchLimits limits;
+    string eval_name;
+    SearchOptions options;
+    
+public:
+    BatchAnalyzer(int threads = 0, int lines = 1, int depth = 6, string eval = "advanced",
+                  int movetime_ms = 0)
+        : num_threads(threads), multipv(lines), eval_name(eval) {
+        if (num_threads <= 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+        limits.depth = depth;
+        limits.movetime_ms = movetime_ms;
+    }
+    
+    void setSearchOptions(const SearchOptions& search_options) { options = search_options; }
+    int getThreads() const { return num_threads; }
+    
+    // on_result(const BatchAnalysisItem&) به ترتیب ورودی و هر بار از یک نخ صدا زده می‌شود
+    template<class Callback>
+    void run(const vector<uint64_t>& positions, Callback&& on_result) {
+        atomic<size_t> next_position(0);
+        mutex emit_mutex;
+        map<size_t, BatchAnalysisItem> pending;
+        size_t next_emit = 0;
+        
+        auto worker = [&]() {
+            MinimaxAgent agent(PieceType::BLACK_PIECE, limits.depth, true, eval_name);
+            agent.setSearchOptions(options);
+            CheckersGame game;
+            size_t index;
+            while ((index = next_position.fetch_add(1)) < positions.size()) {
+                BatchAnalysisItem item;
+                item.index = index;
+                item.position = positions[index];
+                if (game.unpack(item.position) && !game.isGameOver()) {
+                    agent.clearTranspositionTable();
+                    item.result = agent.analyze(game, multipv, limits);
+                }
+                
+                lock_guard<mutex> lock(emit_mutex);
+                pending.emplace(index, move(item));
+                while (!pending.empty() && pending.begin()->first == next_emit) {
+                    on_result(pending.begin()->second);
+                    pending.erase(pending.begin());
+                    next_emit++;
+                }
+            }
+        };
+        
+        vector<thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+};
+
+// یک سطر JSON برای خروجی analyze
+string analysisToJson(const BatchAnalysisItem& item) {
+    CheckersGame position;
+    position.unpack(item.position);
+    ostringstream out;
+    out << "{\"index\":" << item.index << ",\"fen\":\"" << position.toFen()
+        << "\",\"depth\":" << item.result.depth << ",\"nodes\":" << item.result.nodes
+        << ",\"time_ms\":" << item.result.elapsed_ms << ",\"lines\":[";
+    for (size_t i = 0; i < item.result.lines.size(); i++) {
+        const AnalysisLine& line = item.result.lines[i];
+        out << (i ? "," : "") << "{\"move\":\"" << moveToString(line.move)
+            << "\",\"score\":" << line.score << ",\"pv\":\"";
+        for (size_t j = 0; j < line.pv.size(); j++) {
+            out << (j ? " " : "") << moveToString(line.pv[j]);
+        }
+        out << "\"}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+// ============================================================================
+// حل‌کننده proof-number عمق-اول (df-pn) برای مقدار نظری موقعیت‌های 6x6
+// ============================================================================
+
+// مدخل جدول df-pn؛ کلید دقیق است (موقعیت فشرده، شمارنده و هدف) پس برخورد ندارد
+struct DfpnEntry {
+    uint64_t key = 0;            // 0: خالی (صفحه خالی هرگز جستجو نمی‌شود)
+    uint32_t phi = 0;
+    uint32_t delta = 0;
+    uint64_t work = 0;           // گره‌های گسترش‌یافته زیر این مدخل
+};
+
+// جدول با حافظه محدود: سطل‌های دوتایی؛ مدخل با کار کمتر جایگزین می‌شود.
+// ذخیره همیشه انجام می‌شود تا والد مقدار تازه فرزند را بلافاصله ببیند.
+class DfpnTable {
+private:
+    vector<DfpnEntry> entries;
+    size_t bucket_mask = 0;
+    size_t used = 0;
+    
+    size_t bucket(uint64_t key) const {
+        uint64_t mixed = key;
+        return static_cast<size_t>(splitMix64(mixed)) & bucket_mask;
+    }
+    
+public:
+    explicit DfpnTable(size_t megabytes = 64) {
+        size_t buckets = 1;
+        while (buckets * 4 * sizeof(DfpnEntry) <= megabytes * 1024 * 1024) {
+            buckets *= 2;
+        }
+        entries.assign(buckets * 2, DfpnEntry());
+        bucket_mask = buckets - 1;
+    }
+    
+    bool lookup(uint64_t key, uint32_t& phi, uint32_t& delta) const {
+        const DfpnEntry* slot = &entries[bucket(key) * 2];
+        for (int i = 0; i < 2; i++) {
+            if (slot[i].key == key) {
+                phi = slot[i].phi;
+                delta = slot[i].delta;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void store(uint64_t key, uint32_t phi, uint32_t delta, uint64_t work) {
+        DfpnEntry* slot = &entries[bucket(key) * 2];
+        DfpnEntry* target = (slot[0].key == key || slot[0].key == 0) ? &slot[0]
+                          : (slot[1].key == key || slot[1].key == 0) ? &slot[1]
+                          : (slot[0].work <= slot[1].work ? &slot[0] : &slot[1]);
+        used += (target->key == 0);
+        target->key = key;
+        target->phi = phi;
+        target->delta = delta;
+        target->work = work;
+    }
+    
+    size_t capacity() const { return entries.size(); }
+    size_t size() const { return used; }
+};
+
+// جستجوی df-pn تک‌نخی. هر گره هدفی بولی برای بازیکن در نوبت دارد: «می‌برد»
+// یا (با MODE_BIT) «نمی‌بازد». phi/delta از دید بازیکن در نوبت است:
+// phi(n) = min delta(c) و delta(n) = sum phi(c)، و هدف فرزندان هدف مکمل است.
+// قانون مساوی 30 نیم‌حرکت بدون capture با شمارنده داخل کلید مدل می‌شود، پس
+// نمودار حالت‌ها بدون چرخه است؛ تکرار سه‌باره مدل نمی‌شود.
+class DfpnSearch {
+public:
+    static constexpr uint32_t INF = numeric_limits<uint32_t>::max();
+    static constexpr uint64_t MODE_BIT = uint64_t(1) << 62;
+    static constexpr uint64_t POSITION_MASK = (uint64_t(1) << 63) | ((uint64_t(1) << SOLVED_COUNTER_SHIFT) - 1);
+    
+private:
+    // phi/delta فرزند: ثابت برای پایانی‌ها، وگرنه آخرین مقدار دیده‌شده تا اگر
+    // مدخلش از جدول بیرون رانده شد به (1, 1) برنگردد و جستجو درجا نزند
+    struct Child {
+        uint64_t key;
+        bool terminal;
+        uint32_t phi = 1;
+        uint32_t delta = 1;
+    };
+    
+    DfpnTable table;
+    long long nodes = 0;
+    long long max_nodes;
+    const atomic<bool>* stop;
+    bool aborted = false;
+    
+    static int counterOf(uint64_t key) {
+        return static_cast<int>((key >> SOLVED_COUNTER_SHIFT) & 31);
+    }
+    
+    // مقدار پایانی برای هدف؛ false اگر موقعیت پایانی نباشد
+    static bool terminalValue(const CheckersGame& game, int counter, bool not_lose,
+                              uint32_t& phi, uint32_t& delta) {
+        bool proved;
+        if (game.isGameOver()) {
+            PieceType winner = game.getWinner();
+            proved = (winner == game.getCurrentPlayer()) || (winner == PieceType::EMPTY && not_lose);
+        } else if (counter >= Rules6x6::DRAW_PLIES) {
+            proved = not_lose;
+        } else {
+            return false;
+        }
+        phi = proved ? 0 : INF;
+        delta = proved ? INF : 0;
+        return true;
+    }
+    
+    void expand(uint64_t key, vector<Child>& children) const {
+        CheckersGame game;
+        game.unpack(key & POSITION_MASK);
+        const int counter = counterOf(key);
+        const bool not_lose = (key & MODE_BIT) != 0;
+        
+        children.clear();
+        for (const auto& move : game.getAllValidMoves(game.getCurrentPlayer())) {
+            CheckersGame child = game.copy();
+            child.applyMove(move);
+            int child_counter = move.is_capture ? 0 : counter + 1;
+            Child c;
+            c.key = solvedKey(child.pack(), child_counter) | (not_lose ? 0 : MODE_BIT);
+            c.terminal = terminalValue(child, child_counter, !not_lose, c.phi, c.delta);
+            if (!c.terminal) {
+                table.lookup(c.key, c.phi, c.delta);
+            }
+            children.push_back(c);
+        }
+    }
+    
+    void childValue(Child& child, uint32_t& phi, uint32_t& delta) const {
+        if (!child.terminal) {
+            table.lookup(child.key, child.phi, child.delta);
+        }
+        phi = child.phi;
+        delta = child.delta;
+    }
+    
+    // گسترش تا وقتی phi یا delta به آستانه برسد (با آستانه 1+ε برای فرزند)
+    void mid(uint64_t key, uint32_t th_phi, uint32_t th_delta, uint32_t& phi, uint32_t& delta) {
+        const long long nodes_before = nodes++;
+        vector<Child> children;
+        expand(key, children);
+        
+        while (true) {
+            phi = INF;
+            uint32_t second_delta = INF;
+            uint32_t best_phi = 0;
+            uint64_t sum_phi = 0;
+            size_t best = 0;
+            for (size_t i = 0; i < children.size(); i++) {
+                uint32_t child_phi, child_delta;
+                childValue(children[i], child_phi, child_delta);
+                sum_phi = (child_phi == INF || sum_phi == INF) ? INF : sum_phi + child_phi;
+                if (child_delta < phi) {
+                    second_delta = phi;
+                    phi = child_delta;
+                    best_phi = child_phi;
+                    best = i;
+                } else if (child_delta < second_delta) {
+                    second_delta = child_delta;
+                }
+            }
+            delta = static_cast<uint32_t>(sum_phi == INF ? INF : min<uint64_t>(sum_phi, INF - 1));
+            
+            if (phi >= th_phi || delta >= th_delta || abortRequested()) {
+                break;
+            }
+            
+            uint64_t child_th_phi = (th_delta == INF) ? INF : uint64_t(th_delta) - delta + best_phi;
+            uint64_t child_th_delta = (second_delta == INF)
+                ? INF : max<uint64_t>(second_delta + 1, second_delta + second_delta / 4);
+            mid(children[best].key, static_cast<uint32_t>(min<uint64_t>(child_th_phi, INF)),
+                static_cast<uint32_t>(min<uint64_t>(min<uint64_t>(child_th_delta, th_phi), INF)),
+                children[best].phi, children[best].delta);
+        }
+        table.store(key, phi, delta, static_cast<uint64_t>(nodes - nodes_before));
+    }
+    
+    bool abortRequested() {
+        if (!aborted && ((max_nodes > 0 && nodes >= max_nodes) ||
+                         (stop != nullptr && stop->load(memory_order_relaxed)))) {
+            aborted = true;
+        }
+        return aborted;
+    }
+    
+    // موقعیت‌های درخت اثبات/رد: یک فرزند ردشده برای گره اثبات‌شده، همه فرزندان
+    // برای گره ردشده. مدخل‌های بیرون‌رانده‌شده تک گره شمرده می‌شوند.
+    long long proofTreeSize(uint64_t key, unordered_map<uint64_t, bool>& visited) const {
+        if (!visited.emplace(key, true).second) {
+            return 0;
+        }
+        uint32_t phi, delta;
+        if (!table.lookup(key, phi, delta) || (phi != 0 && delta != 0)) {
+            return 1;
+        }
+        vector<Child> children;
+        expand(key, children);
+        long long size = 1;
+        for (auto& child : children) {
+            uint32_t child_phi, child_delta;
+            childValue(child, child_phi, child_delta);
+            if (phi == 0 && child_delta == 0) {
+                return size + (child.terminal ? 1 : proofTreeSize(child.key, visited));
+            }
+            if (delta == 0) {
+                size += child.terminal ? 1 : proofTreeSize(child.key, visited);
+            }
+        }
+        return size;
+    }
+    
+public:
+    DfpnSearch(size_t tt_megabytes = 64, long long node_limit = 0, const atomic<bool>* stop_flag = nullptr)
+        : table(tt_megabytes), max_nodes(node_limit), stop(stop_flag) {}
+    
+    // اثبات هدف بولی برای کلید؛ proved و proof_size در صورت پایان
+    bool prove(uint64_t key, bool& proved, long long& proof_size) {
+        uint32_t phi = 1, delta = 1;
+        mid(key, INF, INF, phi, delta);
+        if (phi != 0 && delta != 0) {
+            return false;
+        }
+        proved = (phi == 0);
+        unordered_map<uint64_t, bool> visited;
+        proof_size += proofTreeSize(key, visited);
+        return true;
+    }
+    
+    // مقدار نظری موقعیت (کلید solvedKey) از دید بازیکن در نوبت
+    SolvedValue solveValue(uint64_t key, long long& proof_size) {
+        bool proved = false;
+        if (!prove(key, proved, proof_size)) {
+            return SolvedValue::UNKNOWN;
+        }
+        if (proved) {
+            return SolvedValue::WIN;
+        }
+        if (!prove(key | MODE_BIT, proved, proof_size)) {
+            return SolvedValue::UNKNOWN;
+        }
+        return proved ? SolvedValue::DRAW : SolvedValue::LOSS;
+    }
+    
+    long long getNodes() const { return nodes; }
+    bool wasAborted() const { return aborted; }
+    const DfpnTable& getTable() const { return table; }
+};
+
+struct SolveResult {
+    SolvedValue value = SolvedValue::UNKNOWN;
+    Move best_move;                                // برای بُرد یا مساوی
+    long long nodes = 0;
+    long long proof_size = 0;                      // موقعیت‌های درخت‌های اثبات
+    double elapsed_ms = 0.0;
+    vector<pair<Move, SolvedValue>> moves;         // مقدار هر حرکت از دید بازیکن ریشه
+};
+
+// تقسیم ریشه بین نخ‌ها: هر نخ df-pn خودش را با سهمی از حافظه دارد و حرکات
+// ریشه را یکی‌یکی برمی‌دارد. با یافتن حرکت بُرد بقیه متوقف می‌شوند.
+class DfpnSolver {
+private:
+    int num_threads;
+    size_t tt_megabytes;
+    long long max_nodes;
+    
+    static SolvedValue negate(SolvedValue value) {
+        if (value == SolvedValue::WIN) return SolvedValue::LOSS;
+        if (value == SolvedValue::LOSS) return SolvedValue::WIN;
+        return value;
+    }
+    
+public:
+    DfpnSolver(int threads = 0, size_t tt_mb = 256, long long node_limit = 0)
+        : num_threads(threads), tt_megabytes(tt_mb), max_nodes(node_limit) {
+        if (num_threads <= 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+    }
+    
+    int getThreads() const { return num_threads; }
+    
+    SolveResult solve(const CheckersGame& game) {
+        auto start = chrono::steady_clock::now();
+        SolveResult result;
+        if (game.isGameOver()) {
+            PieceType winner = game.getWinner();
+            result.value = (winner == PieceType::EMPTY) ? SolvedValue::DRAW
+                         : (winner == game.getCurrentPlayer()) ? SolvedValue::WIN : SolvedValue::LOSS;
+            return result;
+        }
+        
+        vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+        vector<SolvedValue> values(moves.size(), SolvedValue::UNKNOWN);
+        vector<long long> proof_sizes(moves.size(), 0);
+        vector<uint64_t> child_keys(moves.size());
+        const int counter = game.pliesSinceCapture();
+        for (size_t i = 0; i < moves.size(); i++) {
+            CheckersGame child = game.copy();
+            child.applyMove(moves[i]);
+            int child_counter = moves[i].is_capture ? 0 : counter + 1;
+            child_keys[i] = solvedKey(child.pack(), child_counter);
+            // فرزند پایانی مستقیماً (از دید بازیکن ریشه)
+            if (child.isGameOver() || child_counter >= Rules6x6::DRAW_PLIES) {
+                bool draw = !child.isGameOver() || child.getWinner() == PieceType::EMPTY;
+                values[i] = draw ? SolvedValue::DRAW
+                          : (child.getWinner() == game.getCurrentPlayer() ? SolvedValue::WIN : SolvedValue::LOSS);
+                proof_sizes[i] = 1;
+            }
+        }
+        
+        atomic<bool> found_win(false);
+        for (auto value : values) {
+            found_win = found_win || value == SolvedValue::WIN;
+        }
+        atomic<size_t> next_move(0);
+        atomic<long long> total_nodes(0);
+        const size_t per_thread_mb = max<size_t>(1, tt_megabytes / num_threads);
+        
+        auto worker = [&]() {
+            DfpnSearch search(per_thread_mb, max_nodes, &found_win);
+            size_t i;
+            while ((i = next_move.fetch_add(1)) < moves.size()) {
+                if (values[i] != SolvedValue::UNKNOWN || found_win) {
+                    continue;
+                }
+                long long proof = 0;
+                SolvedValue value = negate(search.solveValue(child_keys[i], proof));
+                values[i] = value;
+                proof_sizes[i] = proof;
+                if (value == SolvedValue::WIN) {
+                    found_win = true;
+                }
+            }
+            total_nodes += search.getNodes();
+        };
+        
+        vector<thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        
+        // بُرد اگر یک حرکت ببرد؛ در غیر این صورت فقط وقتی همه حرکات حل شده‌اند
+        bool any_unknown = false, any_draw = false;
+        for (size_t i = 0; i < moves.size(); i++) {
+            result.moves.emplace_back(moves[i], values[i]);
+            any_unknown = any_unknown || values[i] == SolvedValue::UNKNOWN;
+            any_draw = any_draw || values[i] == SolvedValue::DRAW;
+        }
+        result.value = found_win ? SolvedValue::WIN
+                     : any_unknown ? SolvedValue::UNKNOWN
+                     : any_draw ? SolvedValue::DRAW : SolvedValue::LOSS;
+        
+        result.proof_size = 1;
+        for (size_t i = 0; i < moves.size(); i++) {
+            if (values[i] != SolvedValue::UNKNOWN) {
+                result.proof_size += proof_sizes[i];
+            }
+            if (values[i] == result.value && result.best_move.to.empty() &&
+                (result.value == SolvedValue::WIN || result.value == SolvedValue::DRAW)) {
+                result.best_move = moves[i];
+            }
+        }
+        result.nodes = total_nodes;
+        result.elapsed_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return result;
+    }
+    
+    // ثبت نتیجه ریشه و فرزندان حل‌شده در جدول خروجی
+    static void exportResult(const CheckersGame& game, const SolveResult& result, SolvedTable& table) {
+        if (result.value == SolvedValue::UNKNOWN) {
+            return;
+        }
+        SolvedEntry root;
+        root.value = result.value;
+        if (!result.best_move.to.empty()) {
+            root.best_from = MovePicker<CheckersGame>::fromSquare(result.best_move);
+            root.best_to = MovePicker<CheckersGame>::toSquare(result.best_move);
+        }
+        table[solvedKey(game)] = root;
+        for (const auto& [move, value] : result.moves) {
+            if (value == SolvedValue::UNKNOWN) {
+                continue;
+            }
+            CheckersGame child = game.copy();
+            child.applyMove(move);
+            SolvedEntry entry;
+            entry.value = negate(value);
+            table.emplace(solvedKey(child), entry);
+        }
+    }
+};
+
+// ============================================================================
+// پردازش دسته‌ای صفحه‌های 6x6: bitboardهای SoA با هسته‌های برداری
+// ============================================================================
+
+// هر صفحه یک «خط» 32 بیتی است: بیت s-1 خانه s (ترتیب squareNumber، 3 خانه در هر سطر).
+// یک گام قطری در این چیدمان جابه‌جایی 2، 3 یا 4 بیتی است که به زوج یا فرد بودن سطر
+// بستگی دارد؛ پس حرکت‌ها و captureهای همه خطوط با چند shift و and هم‌زمان حساب می‌شوند.
+const uint32_t LANE_ALL = 0x3FFFF;
+const uint32_t LANE_EVEN_ROWS = 0x071C7;                                 // سطرهای 0، 2، 4
+const uint32_t LANE_ODD_ROWS = LANE_ALL ^ LANE_EVEN_ROWS;
+const uint32_t LANE_RIGHT_EDGE = (1u << 2) | (1u << 8) | (1u << 14);     // ستون 5
+const uint32_t LANE_LEFT_EDGE = (1u << 3) | (1u << 9) | (1u << 15);      // ستون 0
+
+static_assert(CheckersGame::SQUARES == 18, "lane layout assumes the 6x6 board");
+
+// ورودی: صفحه‌ها به شکل ستون‌های جدا (SoA)
+struct BoardBatch {
+    vector<uint32_t> black;              // همه مهره‌های سیاه
+    vector<uint32_t> white;
+    vector<uint32_t> kings;              // شاه‌های هر دو رنگ
+    vector<uint32_t> white_to_move;      // 0 یا 1
+    
+    size_t size() const { return black.size(); }
+    
+    void clear() {
+        black.clear();
+        white.clear();
+        kings.clear();
+        white_to_move.clear();
+    }
+    
+    // از شکل فشرده CheckersGame::pack
+    void add(uint64_t packed) { kernels().unpack_boards(&packed, 1, *this); }
+    void add(const uint64_t* packed, size_t count) { kernels().unpack_boards(packed, count, *this); }
+};
+
+// خروجی هر خط، از دید بازیکن در نوبت
+struct BoardBatchResult {
+    vector<uint32_t> movers;             // مهره‌هایی که حرکت ساده دارند
+    vector<uint32_t> jumpers;            // مهره‌هایی که دست‌کم یک capture دارند (پیش از قانون بیشترین capture)
+    vector<uint32_t> simple_moves;       // تعداد حرکات ساده
+    vector<int32_t> men_diff;            // مهره‌های ساده خودی منهای حریف
+    vector<int32_t> king_diff;
+    vector<double> material;             // معادل evaluateBasic
+    
+    // مبدأ حرکات مجاز: capture اجباری است
+    uint32_t legalFrom(size_t lane) const { return jumpers[lane] ? jumpers[lane] : movers[lane]; }
+    
+    void resize(size_t n) {
+        movers.resize(n);
+        jumpers.resize(n);
+        simple_moves.resize(n);
+        men_diff.resize(n);
+        king_diff.resize(n);
+        material.resize(n);
+    }
+};
+
+// بیت bit از کد 3 بیتی هر خانه در شکل فشرده
+constexpr uint64_t packedCodeMask(int bit) {
+    uint64_t mask = 0;
+    for (int square = 0; square < CheckersGame::SQUARES; square++) {
+        mask |= 1ULL << (3 * square + bit);
+    }
+    return mask;
+}
+
+// کدهای فرد (1، 3) سیاه، زوج غیر صفر (2، 4) سفید و 3 به بالا شاه‌اند
+void unpackBoardsLoop(const uint64_t* packed, size_t count, BoardBatch& batch) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t b = 0, w = 0, k = 0;
+        for (int square = 0; square < CheckersGame::SQUARES; square++) {
+            uint32_t code = (packed[i] >> (3 * square)) & 7;
+            b |= (code & 1) << square;
+            w |= uint32_t(code != 0 && (code & 1) == 0) << square;
+            k |= uint32_t(code >= 3) << square;
+        }
+        batch.black.push_back(b);
+        batch.white.push_back(w);
+        batch.kings.push_back(k);
+        batch.white_to_move.push_back(static_cast<uint32_t>(packed[i] >> 63));
+    }
+}
+
+#ifdef CHECKERS_X86
+// همان نگاشت با سه PEXT: هر بیت کد همه خانه‌ها یک‌جا جمع می‌شود
+CHECKERS_TARGET("bmi2") void unpackBoardsPext(const uint64_t* packed, size_t count, BoardBatch& batch) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t b0 = static_cast<uint32_t>(_pext_u64(packed[i], packedCodeMask(0)));
+        uint32_t b1 = static_cast<uint32_t>(_pext_u64(packed[i], packedCodeMask(1)));
+        uint32_t b2 = static_cast<uint32_t>(_pext_u64(packed[i], packedCodeMask(2)));
+        batch.black.push_back(b0);
+        batch.white.push_back(~b0 & (b1 | b2));
+        batch.kings.push_back((b0 & b1) | b2);
+        batch.white_to_move.push_back(static_cast<uint32_t>(packed[i] >> 63));
+    }
+}
+#endif
+
+// خط‌ها: V یک خط (uint32_t) یا بردار GCC/Clang با W خط است. عملگرهای & | ~ + - << >> (و عملوند
+// اسکالر) روی هر دو یکسان‌اند، پس هسته یک بار نوشته می‌شود و با هر پهنا نمونه‌سازی می‌شود؛ بدون
+// intrinsic تا داخل تابع target("avx2") با همان ISA کامپایل شود. بردار 32 بایتی بیرون از AVX در ABI
+// فراخوانی فرق دارد، پس هیچ تابع کمکی V را با مقدار نمی‌گیرد یا برنمی‌گرداند: نتیجه در پارامتر خروجی.
+struct ScalarLanes {
+    using V = uint32_t;
+    static constexpr int WIDTH = 1;
+    static CHECKERS_INLINE void load(V& v, const uint32_t* p) { v = *p; }
+    static CHECKERS_INLINE void store(uint32_t* p, const V& v) { *p = v; }
+    static CHECKERS_INLINE void storeSigned(int32_t* p, const V& v) { *p = static_cast<int32_t>(v); }
+};
+
+template<int W>
+struct VectorLanes {
+    typedef uint32_t V __attribute__((vector_size(4 * W)));
+    static constexpr int WIDTH = W;
+    static CHECKERS_INLINE void load(V& v, const uint32_t* p) { memcpy(&v, p, sizeof(v)); }
+    static CHECKERS_INLINE void store(uint32_t* p, const V& v) { memcpy(p, &v, sizeof(v)); }
+    static CHECKERS_INLINE void storeSigned(int32_t* p, const V& v) { memcpy(p, &v, sizeof(v)); }
+};
+
+// گام‌های قطری و شمارش بیت روی همه خطوط
+template<class L>
+struct LaneSteps {
+    using V = typename L::V;
+    
+    enum Direction { DOWN_LEFT, DOWN_RIGHT, UP_LEFT, UP_RIGHT };
+    
+    // out: خانه‌های x پس از یک گام در جهت D
+    template<Direction D>
+    static CHECKERS_INLINE void step(V& out, const V& x) {
+        if constexpr (D == DOWN_LEFT) {          // (+1, -1)
+            out = (((x & LANE_EVEN_ROWS) << 3) | ((x & (LANE_ODD_ROWS & ~LANE_LEFT_EDGE)) << 2)) & LANE_ALL;
+        } else if constexpr (D == DOWN_RIGHT) {  // (+1, +1)
+            out = (((x & (LANE_EVEN_ROWS & ~LANE_RIGHT_EDGE)) << 4) | ((x & LANE_ODD_ROWS) << 3)) & LANE_ALL;
+        } else if constexpr (D == UP_LEFT) {     // (-1, -1)
+            out = ((x & LANE_EVEN_ROWS) >> 3) | ((x & (LANE_ODD_ROWS & ~LANE_LEFT_EDGE)) >> 4);
+        } else {                                 // (-1, +1)
+            out = ((x & (LANE_EVEN_ROWS & ~LANE_RIGHT_EDGE)) >> 2) | ((x & LANE_ODD_ROWS) >> 3);
+        }
+    }
+    
+    static CHECKERS_INLINE void popcount(V& out, const V& value) {
+        V x = value - ((value >> 1) & 0x55555555u);
+        x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+        x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+        x = x + (x >> 8);
+        x = x + (x >> 16);
+        out = x & 0x3Fu;
+    }
+    
+    // مهره‌هایی از origins که در جهت Step (و برعکس آن Back) روی حریف می‌پرند
+    template<Direction Step, Direction Back>
+    static CHECKERS_INLINE void jumpers(V& out, const V& origins, const V& opp, const V& empty) {
+        V next, land;
+        step<Step>(next, origins);
+        step<Step>(land, next & opp);
+        land &= empty;
+        step<Back>(next, land);
+        step<Back>(out, next);
+    }
+};
+
+// هسته مشترک: خطوط [begin, end) که end - begin مضرب L::WIDTH است
+template<class L>
+CHECKERS_INLINE void analyzeLanes(const BoardBatch& batch, BoardBatchResult& out, size_t begin, size_t end) {
+    using V = typename L::V;
+    using S = LaneSteps<L>;
+    for (size_t i = begin; i < end; i += L::WIDTH) {
+        V black, white, kings, white_to_move;
+        L::load(black, &batch.black[i]);
+        L::load(white, &batch.white[i]);
+        L::load(kings, &batch.kings[i]);
+        L::load(white_to_move, &batch.white_to_move[i]);
+        const V side = V{} - white_to_move;      // همه بیت‌ها یک: نوبت سفید
+        
+        const V own = (side & white) | (~side & black);
+        const V opp = (side & black) | (~side & white);
+        const V empty = ~(own | opp) & LANE_ALL;
+        const V own_kings = own & kings;
+        const V opp_kings = opp & kings;
+        // سیاه رو به پایین و سفید رو به بالا حرکت می‌کند؛ شاه‌ها در هر دو جهت
+        const V down = (side & own_kings) | (~side & own);
+        const V up = (side & own) | (~side & own_kings);
+        
+        // مقصدهای حرکت ساده در هر جهت و مبدأ آن‌ها
+        V dl, dr, ul, ur;
+        S::template step<S::DOWN_LEFT>(dl, down);
+        S::template step<S::DOWN_RIGHT>(dr, down);
+        S::template step<S::UP_LEFT>(ul, up);
+        S::template step<S::UP_RIGHT>(ur, up);
+        dl &= empty;
+        dr &= empty;
+        ul &= empty;
+        ur &= empty;
+        V from_dl, from_dr, from_ul, from_ur;
+        S::template step<S::UP_RIGHT>(from_dl, dl);
+        S::template step<S::UP_LEFT>(from_dr, dr);
+        S::template step<S::DOWN_RIGHT>(from_ul, ul);
+        S::template step<S::DOWN_LEFT>(from_ur, ur);
+        L::store(&out.movers[i], (from_dl | from_dr) | (from_ul | from_ur));
+        
+        V count_dl, count_dr, count_ul, count_ur;
+        S::popcount(count_dl, dl);
+        S::popcount(count_dr, dr);
+        S::popcount(count_ul, ul);
+        S::popcount(count_ur, ur);
+        L::store(&out.simple_moves[i], (count_dl + count_dr) + (count_ul + count_ur));
+        
+        V jump_dl, jump_dr, jump_ul, jump_ur;
+        S::template jumpers<S::DOWN_LEFT, S::UP_RIGHT>(jump_dl, down, opp, empty);
+        S::template jumpers<S::DOWN_RIGHT, S::UP_LEFT>(jump_dr, down, opp, empty);
+        S::template jumpers<S::UP_LEFT, S::DOWN_RIGHT>(jump_ul, up, opp, empty);
+        S::template jumpers<S::UP_RIGHT, S::DOWN_LEFT>(jump_ur, up, opp, empty);
+        L::store(&out.jumpers[i], (jump_dl | jump_dr) | (jump_ul | jump_ur));
+        
+        V own_men, opp_men, own_king_count, opp_king_count;
+        S::popcount(own_men, ~kings & own);
+        S::popcount(opp_men, ~kings & opp);
+        S::popcount(own_king_count, own_kings);
+        S::popcount(opp_king_count, opp_kings);
+        L::storeSigned(&out.men_diff[i], own_men - opp_men);
+        L::storeSigned(&out.king_diff[i], own_king_count - opp_king_count);
+    }
+}
+
+// بدنه با پهنای برداری، دنباله با نسخه اسکالر
+template<class L>
+CHECKERS_INLINE void analyzeLanesVector(const BoardBatch& batch, BoardBatchResult& out) {
+    const size_t n = batch.size();
+    const size_t vector_end = n - n % L::WIDTH;
+    analyzeLanes<L>(batch, out, 0, vector_end);
+    analyzeLanes<ScalarLanes>(batch, out, vector_end, n);
+}
+
+void analyzeLanesVector4(const BoardBatch& batch, BoardBatchResult& out) {
+    analyzeLanesVector<VectorLanes<4>>(batch, out);
+}
+
+#ifdef CHECKERS_X86
+CHECKERS_TARGET("avx2") void analyzeLanesAvx2(const BoardBatch& batch, BoardBatchResult& out) {
+    analyzeLanesVector<VectorLanes<8>>(batch, out);
+}
+#endif
+
+// تحلیل همه خطوط با هسته انتخابی، سپس ماده
+void analyzeBatch(const BoardBatch& batch, BoardBatchResult& out) {
+    const size_t n = batch.size();
+    out.resize(n);
+    kernels().analyze_lanes(batch, out);
+    
+    const double man = evalParams().man();
+    const double king = evalParams().king();
+    for (size_t i = 0; i < n; i++) {
+        out.material[i] = man * out.men_diff[i] + king * out.king_diff[i];
+    }
+}
+
+// جدول هسته‌های هر سطح؛ هر سطح همه هسته‌های سطح پایین‌تر را به ارث می‌برد
+const EngineKernels& kernelsFor(IsaLevel level) {
+    static const array<EngineKernels, 4> table = []() {
+        array<EngineKernels, 4> levels;
+        EngineKernels& base = levels[static_cast<int>(IsaLevel::BASELINE)];
+#if defined(__SSE2__)
+        base.nnue_dot_rows = nnueDotRowsSse2;
+        base.axpy = texelAxpySse2;
+        base.dot = texelDotSse2;
+#else
+        base.nnue_dot_rows = nnueDotRowsScalar;
+        base.axpy = texelAxpyScalar;
+        base.dot = texelDotScalar;
+#endif
+        base.unpack_boards = unpackBoardsLoop;
+        base.analyze_lanes = analyzeLanesVector4;
+        base.hash_bytes = hashBytesDefault;
+        
+        for (int i = 1; i < 4; i++) {
+            levels[i] = levels[i - 1];
+            levels[i].isa = static_cast<IsaLevel>(i);
+        }
+#ifdef CHECKERS_X86
+        levels[static_cast<int>(IsaLevel::SSE42)].hash_bytes = hashBytesCrc32;
+        for (IsaLevel avx : {IsaLevel::AVX2, IsaLevel::BMI2}) {
+            EngineKernels& k = levels[static_cast<int>(avx)];
+            k.hash_bytes = hashBytesCrc32;
+            k.nnue_dot_rows = nnueDotRowsAvx2;
+            k.analyze_lanes = analyzeLanesAvx2;
+            k.axpy = texelAxpyAvx2;
+            k.dot = texelDotAvx2;
+        }
+        levels[static_cast<int>(IsaLevel::BMI2)].unpack_boards = unpackBoardsPext;
+#endif
+        return levels;
+    }();
+    // هرگز بالاتر از توان CPU
+    return table[static_cast<int>(min(level, CpuFeatures::host().best()))];
+}
+
+// ============================================================================
+// Perft: شمارش برگ‌های درخت حرکت برای سنجش و اعتبارسنجی تولید حرکت
+// ============================================================================
+
+// موقعیت آزمون با شمارش‌های مرجع برای عمق‌های 1، 2، ...
+struct PerftPosition {
+    string name;
+    string board_key;
+    PieceType to_move;
+    vector<unsigned long long> expected;
+};
+
+const vector<PerftPosition> PERFT_POSITIONS = {
+    {"start", "", PieceType::BLACK_PIECE,
+     {5, 25, 106, 369, 1271, 4031, 12225, 36277, 100091}},
+    {"chain", "000001101000020000000020000202200000", PieceType::BLACK_PIECE,
+     {1, 3, 9, 24, 78, 185, 562, 1429, 3934}},
+    {"kings", "000000001000030200000030020004002000", PieceType::BLACK_PIECE,
+     {5, 6, 25, 68, 195, 881, 2724, 12688, 35501}},
+    {"promo", "010000200020000000000000010100002000", PieceType::WHITE_PIECE,
+     {2, 6, 23, 68, 169, 579, 2005, 6349, 22265}},
+};
+
+// موقعیت شروع 8x8؛ شمارش‌های انگلیسی همان مقادیر مرجع شناخته‌شده checkers هستند
+const vector<PerftPosition> PERFT_POSITIONS_ENGLISH = {
+    {"start", "", PieceType::BLACK_PIECE,
+     {7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680}},
+};
+
+// شمارش‌های گونه پرنده مرجع منتشرشده ندارند؛ با یک پیاده‌سازی مستقل پایتونی از همین قواعد
+// تطبیق داده شده‌اند. kings حرکت و capture شاه پرنده و قانون بیشترین capture را می‌سنجد
+const vector<PerftPosition> PERFT_POSITIONS_FLYING = {
+    {"start", "", PieceType::BLACK_PIECE,
+     {7, 49, 302, 1469, 7361, 36473, 177532, 828783}},
+    {"kings", "0100010000100000000300000000002002000200000020000200000000000040", PieceType::BLACK_PIECE,
+     {1, 6, 43, 288, 1931, 12662, 87225}},
+};
+
+// شمارش برگ‌ها تا عمق depth؛ bulk: شمارش حرکات در لایه آخر بدون اعمال آن‌ها
+template<class Game>
+unsigned long long perft(const Game& game, int depth, bool bulk = true) {
+    if (depth == 0) {
+        return 1;
+    }
+    if (game.isGameOver()) {
+        return 0;
+    }
+
+    vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+    if (bulk && depth == 1) {
+        return moves.size();
+    }
+
+    unsigned long long nodes = 0;
+    for (const auto& move : moves) {
+        Game child = game.copy();
+        child.applyMove(move);
+        nodes += perft(child, depth - 1, bulk);
+    }
+    return nodes;
+}
+
+class PerftRunner {
+private:
+    int num_threads;
+    bool bulk;
+
+public:
+    PerftRunner(int threads = 1, bool bulk_count = true) : num_threads(threads), bulk(bulk_count) {
+        if (num_threads <= 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+    }
+
+    // تقسیم حرکات ریشه بین نخ‌ها؛ divide شمارش هر حرکت ریشه را چاپ می‌کند
+    template<class Game>
+    unsigned long long run(const Game& game, int depth, bool divide) {
+        if (depth <= 1 || (num_threads == 1 && !divide)) {
+            return perft(game, depth, bulk);
+        }
+
+        vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+        vector<unsigned long long> counts(moves.size(), 0);
+        atomic<size_t> next_move(0);
+
+        auto worker = [&]() {
+            size_t i;
+            while ((i = next_move.fetch_add(1)) < moves.size()) {
+                Game child = game.copy();
+                child.applyMove(moves[i]);
+                counts[i] = perft(child, depth - 1, bulk);
+            }
+        };
+
+        vector<thread> workers;
+        for (int t = 0; t < min<int>(num_threads, moves.size()); t++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        unsigned long long total = 0;
+        for (size_t i = 0; i < moves.size(); i++) {
+            if (divide) {
+                cout << "  " << moveToString(moves[i]) << ": " << counts[i] << endl;
+            }
+            total += counts[i];
+        }
+        return total;
+    }
+
+    // اجرای عمق‌های 1..max_depth برای یک موقعیت؛ false در صورت مغایرت با مرجع
+    template<class Game = CheckersGame>
+    bool runPosition(const PerftPosition& position, int max_depth, bool divide) {
+        Game game;
+        if (!position.board_key.empty()) {
+            game.setFromBoardKey(position.board_key, position.to_move);
+        }
+
+        cout << "position " << position.name << " (" << Game::RuleSet::NAME << ")" << endl;
+        bool ok = true;
+        for (int depth = 1; depth <= max_depth; depth++) {
+            auto start = chrono::steady_clock::now();
+            unsigned long long nodes = run(game, depth, divide && depth == max_depth);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            cout << "  depth " << depth << ": nodes=" << nodes
+                 << " time=" << seconds * 1000.0 << "ms"
+                 << " nps=" << static_cast<long long>(seconds > 0 ? nodes / seconds : 0);
+
+            if (depth <= static_cast<int>(position.expected.size())) {
+                bool match = position.expected[depth - 1] == nodes;
+                cout << (match ? " OK" : " MISMATCH (expected " +
+                         to_string(position.expected[depth - 1]) + ")");
+                ok = ok && match;
+            }
+            cout << endl;
+        }
+        return ok;
+    }
+
+    // اجرای موقعیت‌های انتخاب‌شده (which: نام یا all)؛ کد خروج: 0 درست، 1 ناشناخته، 2 مغایرت
+    template<class Game>
+    int runPositions(const vector<PerftPosition>& positions, const string& which,
+                     int max_depth, bool divide) {
+        bool ok = true;
+        bool found = false;
+        for (const auto& position : positions) {
+            if (which == "all" || which == position.name) {
+                found = true;
+                ok = runPosition<Game>(position, max_depth, divide) && ok;
+            }
+        }
+        if (!found) {
+            cout << "unknown position: " << which << endl;
+            return 1;
+        }
+        return ok ? 0 : 2;
+    }
+};
+
+// ============================================================================
+// ریزسنجه‌های مسیرهای داغ موتور
+// ============================================================================
+
+volatile size_t bench_sink = 0;
+
+struct BenchResult {
+    string name;
+    unsigned long long iterations = 0;
+    double ns_per_op = 0.0;
+    double allocs_per_op = -1.0;   // -1: شمارش تخصیص در این build فعال نیست
+};
+
+class MicroBenchmark {
+private:
+    double min_time_ms;
+    string filter;
+    vector<BenchResult> results;
+
+    // جلوگیری از حذف محاسبات توسط بهینه‌ساز
+    static void keep(size_t value) {
+        bench_sink = value;
+    }
+
+    bool selected(const string& name) const {
+        return filter.empty() || name.find(filter) != string::npos;
+    }
+
+public:
+    MicroBenchmark(double min_ms = 200.0, string f = "") : min_time_ms(min_ms), filter(f) {}
+
+    // اجرای op در 5 نمونه؛ ns/op میانه نمونه‌ها است
+    void run(const string& name, const function<size_t()>& op, unsigned long long max_iterations = 0) {
+        if (!selected(name)) {
+            return;
+        }
+        const int samples = 5;
+
+        // کالیبراسیون تعداد تکرار هر نمونه
+        unsigned long long iterations = 1;
+        while (true) {
+            auto start = chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < iterations; i++) keep(op());
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            if (ms * samples >= min_time_ms || (max_iterations && iterations >= max_iterations)) break;
+            iterations *= 2;
+        }
+
+        vector<double> ns_samples;
+        unsigned long long allocations_before = allocationCount();
+        for (int s = 0; s < samples; s++) {
+            auto start = chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < iterations; i++) keep(op());
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            ns_samples.push_back(ns / iterations);
+        }
+        unsigned long long allocations = allocationCount() - allocations_before;
+        sort(ns_samples.begin(), ns_samples.end());
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = iterations * samples;
+        result.ns_per_op = ns_samples[samples / 2];
+        if (ALLOCATION_COUNTING) {
+            result.allocs_per_op = static_cast<double>(allocations) / result.iterations;
+        }
+        results.push_back(result);
+
+        cout << left << setw(40) << name << right << setw(14) << fixed << setprecision(1)
+             << result.ns_per_op << " ns/op" << setw(12) << setprecision(2)
+             << result.allocs_per_op << " allocs/op" << setw(12) << result.iterations
+             << " iters" << endl;
+        cout.unsetf(ios::floatfield);
+    }
+
+    // خلاصه ماشین‌خوان
+    bool writeJson(const string& filename) const {
+        ofstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << "{\n  \"allocation_counting\": " << (ALLOCATION_COUNTING ? "true" : "false")
+             << ",\n  \"isa\": \"" << isaName(kernels().isa) << "\""
+             << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& r = results[i];
+            file << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+                 << ", \"ns_per_op\": " << r.ns_per_op << ", \"allocs_per_op\": ";
+            if (r.allocs_per_op < 0) file << "null"; else file << r.allocs_per_op;
+            file << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "  ]\n}\n";
+        return true;
+    }
+};
+
+// بذر ثابت موقعیت‌های ریزسنجه؛ جریان‌های دیگر با deriveSeed از آن مشتق می‌شوند
+const uint64_t BENCH_SEED = 12345;
+
+// موقعیت میانه بازی قابل تکرار: 12 حرکت تصادفی با بذر ثابت
+CheckersGame makeBenchMidgame() {
+    CheckersGame game;
+    Xoshiro256 rng(BENCH_SEED);
+    for (int ply = 0; ply < 12 && !game.isGameOver(); ply++) {
+        vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+        if (moves.empty()) break;
+        game.applyMove(moves[rng.below(moves.size())]);
+    }
+    return game;
+}
+
+void runMicroBenchmarks(double min_time_ms, const string& filter, const string& json_file,
+                        const vector<size_t>& experience_sizes) {
+    MicroBenchmark bench(min_time_ms, filter);
+    cout << "allocation counting: " << (ALLOCATION_COUNTING ? "on" : "off (build with -DCHECKERS_BENCH)")
+         << endl;
+    cout << "kernels: " << isaName(kernels().isa) << " (cpu: " << CpuFeatures::host().describe() << ")" << endl;
+
+    CheckersGame start;
+    CheckersGame midgame = makeBenchMidgame();
+    CheckersGame captures;
+    captures.setFromBoardKey(PERFT_POSITIONS[1].board_key, PERFT_POSITIONS[1].to_move);
+
+    vector<Move> mid_moves = midgame.getAllValidMoves(midgame.getCurrentPlayer());
+
+    // تولید حرکت
+    bench.run("getAllValidMoves/start", [&]() {
+        return start.getAllValidMoves(PieceType::BLACK_PIECE).size();
+    });
+    bench.run("getAllValidMoves/midgame", [&]() {
+        return midgame.getAllValidMoves(midgame.getCurrentPlayer()).size();
+    });
+    bench.run("getAllValidMoves/captures", [&]() {
+        return captures.getAllValidMoves(PieceType::BLACK_PIECE).size();
+    });
+    bench.run("MovePicker/first-move", [&]() {
+        MovePicker<CheckersGame> picker(midgame);
+        Move move;
+        return picker.next(move) ? move.to.size() : 0;
+    });
+    bench.run("MovePicker/all-moves", [&]() {
+        MovePicker<CheckersGame> picker(midgame);
+        Move move;
+        size_t count = 0;
+        while (picker.next(move)) {
+            count++;
+        }
+        return count;
+    });
+    bench.run("getCaptureMoves/chain", [&]() {
+        return captures.getCaptureMoves(Position(1, 0), PieceType::BLACK_PIECE, BLACK_DIRECTIONS).size();
+    });
+    EnglishCheckersGame start_8x8;
+    bench.run("getAllValidMoves/8x8-start", [&]() {
+        return start_8x8.getAllValidMoves(PieceType::BLACK_PIECE).size();
+    });
+    bench.run("perft3/8x8-start", [&]() {
+        return static_cast<size_t>(perft(start_8x8, 3));
+    });
+
+    // اعمال حرکت و کپی
+    bench.run("CheckersGame::copy/midgame", [&]() {
+        return midgame.copy().getMoveHistory().size();
+    });
+    bench.run("copy+applyMove/midgame", [&]() {
+        CheckersGame child = midgame.copy();
+        child.applyMove(mid_moves[0]);
+        return child.getMoveHistory().size();
+    });
+    bench.run("getBoardKey/midgame", [&]() {
+        return midgame.getBoardKey().size();
+    });
+    
+    // سریال‌سازی موقعیت
+    CheckersGame decoded;
+    const uint64_t mid_packed = midgame.pack();
+    const string mid_fen = midgame.toFen();
+    bench.run("pack/midgame", [&]() {
+        return static_cast<size_t>(midgame.pack());
+    });
+    bench.run("unpack/midgame", [&]() {
+        decoded.unpack(mid_packed);
+        return static_cast<size_t>(decoded.getHash());
+    });
+    bench.run("toFen/midgame", [&]() {
+        return midgame.toFen().size();
+    });
+    bench.run("setFromFen/midgame", [&]() {
+        decoded.setFromFen(mid_fen);
+        return static_cast<size_t>(decoded.getHash());
+    });
+
+    // توابع ارزیابی
+    MinimaxAgent agent(PieceType::BLACK_PIECE, 3, true, "basic");
+    LinearEvaluator linear;
+    NNUENetwork network;
+    CheckersGame nnue_game = midgame.copy();
+    nnue_game.attachNNUE(&network);
+
+    bench.run("evaluateBasic", [&]() {
+        return static_cast<size_t>(agent.evaluateBasic(midgame, PieceType::BLACK_PIECE) * 100);
+    });
+    bench.run("evaluateAdvanced", [&]() {
+        return static_cast<size_t>(agent.evaluateAdvanced(midgame, PieceType::BLACK_PIECE) * 100);
+    });
+    bench.run("evaluateAdvanced/8x8-start", [&]() {
+        return static_cast<size_t>(agent.evaluateAdvanced(start_8x8, PieceType::BLACK_PIECE) * 100 + 1000);
+    });
+    bench.run("evaluatePositional", [&]() {
+        return static_cast<size_t>(agent.evaluatePositional(midgame, PieceType::BLACK_PIECE) * 100);
+    });
+    bench.run("evaluateLearned", [&]() {
+        return static_cast<size_t>(linear.evaluate(midgame, PieceType::BLACK_PIECE) * 100);
+    });
+    bench.run("evaluateNNUE/incremental", [&]() {
+        return static_cast<size_t>(network.evaluate(nnue_game.getNNUEAccumulator()) * 100);
+    });
+    bench.run("evaluateNNUE/refresh", [&]() {
+        return static_cast<size_t>(agent.evaluateNNUE(midgame, PieceType::BLACK_PIECE) * 100);
+    });
+
+    // پردازش دسته‌ای: 1024 موقعیت بازی تصادفی، هسته SoA در برابر حلقه اسکالر
+    vector<CheckersGame> batch_games;
+    BoardBatch board_batch;
+    Xoshiro256 batch_rng(deriveSeed(BENCH_SEED, 1));
+    while (batch_games.size() < 1024) {
+        CheckersGame game;
+        while (!game.isGameOver() && batch_games.size() < 1024) {
+            batch_games.push_back(game);
+            board_batch.add(game.pack());
+            vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+            game.applyMove(moves[batch_rng.below(moves.size())]);
+        }
+    }
+    BoardBatchResult batch_result;
+    bench.run("BoardBatch/analyze-1024", [&]() {
+        analyzeBatch(board_batch, batch_result);
+        return static_cast<size_t>(batch_result.simple_moves[1023] + batch_result.material[1023] * 100);
+    });
+    bench.run("BoardBatch/scalar-1024", [&]() {
+        size_t total = 0;
+        for (const auto& game : batch_games) {
+            total += game.getAllValidMoves(game.getCurrentPlayer()).size();
+            total += static_cast<size_t>(agent.evaluateBasic(game, game.getCurrentPlayer()) * 100);
+        }
+        return total;
+    });
+
+    // هر هسته در همه سطح‌های ISA که این CPU دارد (فقط سطح‌هایی که نسخه تازه دارند)
+    vector<uint64_t> batch_packed;
+    for (const auto& game : batch_games) batch_packed.push_back(game.pack());
+    alignas(32) array<int16_t, NNUE_HIDDEN> bench_input;
+    for (int k = 0; k < NNUE_HIDDEN; k++) bench_input[k] = static_cast<int16_t>(k * 3 % NNUE_CLIP);
+    alignas(32) array<array<int16_t, NNUE_HIDDEN>, NNUE_L1> bench_rows;
+    for (int n = 0; n < NNUE_L1; n++) {
+        for (int k = 0; k < NNUE_HIDDEN; k++) bench_rows[n][k] = static_cast<int16_t>((n * 7 + k) % 64 - 32);
+    }
+    const string bench_key = midgame.getBoardKey();
+    for (int level = 0; level <= static_cast<int>(CpuFeatures::host().best()); level++) {
+        const EngineKernels& k = kernelsFor(static_cast<IsaLevel>(level));
+        const EngineKernels* lower = level > 0 ? &kernelsFor(static_cast<IsaLevel>(level - 1)) : nullptr;
+        const string isa = isaName(k.isa);
+        if (!lower || k.analyze_lanes != lower->analyze_lanes) {
+            bench.run("kernel/analyze-lanes-1024/" + isa, [&]() {
+                batch_result.resize(board_batch.size());
+                k.analyze_lanes(board_batch, batch_result);
+                return static_cast<size_t>(batch_result.simple_moves[1023]);
+            });
+        }
+        if (!lower || k.unpack_boards != lower->unpack_boards) {
+            BoardBatch unpacked;
+            bench.run("kernel/unpack-1024/" + isa, [&]() {
+                unpacked.clear();
+                k.unpack_boards(batch_packed.data(), batch_packed.size(), unpacked);
+                return static_cast<size_t>(unpacked.kings[1023]);
+            });
+        }
+        if (!lower || k.nnue_dot_rows != lower->nnue_dot_rows) {
+            array<int32_t, NNUE_L1> dots;
+            bench.run("kernel/nnue-dot-rows/" + isa, [&]() {
+                k.nnue_dot_rows(bench_input.data(), bench_rows[0].data(), NNUE_L1, dots.data());
+                return static_cast<size_t>(dots[NNUE_L1 - 1]);
+            });
+        }
+        if (!lower || k.hash_bytes != lower->hash_bytes) {
+            bench.run("kernel/hash-board-key/" + isa, [&]() {
+                return static_cast<size_t>(k.hash_bytes(bench_key.data(), bench_key.size()));
+            });
+        }
+    }
+
+    // بارگذاری و ذخیره تجربه LearningAgent
+    for (size_t entries : experience_sizes) {
+        string label = to_string(entries);
+        string filename = "bench_experience_" + label + ".dat";
+        {
+            LearningAgent writer(PieceType::BLACK_PIECE, 1, true, "basic", 0.1, filename);
+            Move move(Position(1, 0), Position(2, 1));
+            for (size_t i = 0; i < entries; i++) {
+                // کلیدهای یکتا با طول کلید واقعی (36 نویسه)
+                string key = to_string(i);
+                key = string(36 - key.size(), '0') + key;
+                writer.addExperience(key, 0.5, move);
+            }
+            bench.run("LearningAgent::saveExperience/" + label, [&]() {
+                writer.saveExperience();
+                return writer.getExperienceSize();
+            }, 1);
+        }
+        {
+            LearningAgent reader(PieceType::BLACK_PIECE, 1, true, "basic", 0.1, filename);
+            bench.run("LearningAgent::loadExperience/" + label, [&]() {
+                reader.loadExperience();
+                return reader.getExperienceSize();
+            }, 1);
+        }
+        remove(filename.c_str());
+    }
+
+    if (!json_file.empty()) {
+        if (bench.writeJson(json_file)) {
+            cout << "summary written to " << json_file << endl;
+        } else {
+            cout << "cannot write " << json_file << endl;
+        }
+    }
+}
+
+// ============================================================================
+// ثبت تأخیر حرکت‌ها و خروجی ساخت‌یافته آزمایش‌ها
+// ============================================================================
+
+// نمونه‌های تأخیر (میکروثانیه) با صدک‌های دقیق و هیستوگرام توان‌های دو
+class LatencyHistogram {
+private:
+    vector<long long> samples_us;
+
+public:
+    void record(long long us) { samples_us.push_back(us); }
+    void clear() { samples_us.clear(); }
+    size_t count() const { return samples_us.size(); }
+
+    long long percentile(double p) const {
+        if (samples_us.empty()) return 0;
+        vector<long long> sorted = samples_us;
+        size_t index = min(sorted.size() - 1, static_cast<size_t>(ceil(p / 100.0 * sorted.size())) - (p > 0 ? 1 : 0));
+        nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+
+    long long maximum() const {
+        return samples_us.empty() ? 0 : *max_element(samples_us.begin(), samples_us.end());
+    }
+
+    double mean() const {
+        if (samples_us.empty()) return 0.0;
+        long long sum = 0;
+        for (long long us : samples_us) sum += us;
+        return static_cast<double>(sum) / samples_us.size();
+    }
+
+    // خانه k: تأخیرهای کمتر از 2^k میکروثانیه (و بیشتر از خانه قبل)
+    vector<long long> log2Buckets() const {
+        vector<long long> buckets;
+        for (long long us : samples_us) {
+            size_t k = 0;
+            while ((1LL << k) <= us) k++;
+            if (buckets.size() <= k) buckets.resize(k + 1, 0);
+            buckets[k]++;
+        }
+        return buckets;
+    }
+};
+
+// آمار حرکت‌های یک عامل در طول یک تورنمنت
+struct AgentMoveLog {
+    string name;
+    LatencyHistogram latency;
+    long long total_nodes = 0;
+    long long moves = 0;
+
+    void clear(const string& agent_name) {
+        name = agent_name;
+        latency.clear();
+        total_nodes = 0;
+        moves = 0;
+    }
+
+    double nodesPerMove() const {
+        return moves > 0 ? static_cast<double>(total_nodes) / moves : 0.0;
+    }
+
+    string toJson() const {
+        ostringstream out;
+        out << "{\"name\": \"" << name << "\", \"moves\": " << moves
+            << ", \"nodes\": " << total_nodes << ", \"nodes_per_move\": " << nodesPerMove()
+            << ", \"latency_us\": {\"mean\": " << latency.mean()
+            << ", \"p50\": " << latency.percentile(50) << ", \"p95\": " << latency.percentile(95)
+            << ", \"p99\": " << latency.percentile(99) << ", \"max\": " << latency.maximum()
+            << ", \"log2_buckets\": [";
+        vector<long long> buckets = latency.log2Buckets();
+        for (size_t k = 0; k < buckets.size(); k++) {
+            out << (k ? ", " : "") << buckets[k];
+        }
+        out << "]}}";
+        return out.str();
+    }
+};
+
+// یک سطر از رکورد حرکت‌ها
+struct MoveRecord {
+    int game;
+    int ply;
+    int side;       // 0: سیاه، 1: سفید
+    long long latency_us;
+    long long nodes;
+};
+
+// نتیجه یک بازی تورنمنت
+struct ExperimentGame {
+    int game = 0;
+    int winner = 0;     // 0: مساوی، 1: سیاه، 2: سفید
+    int moves = 0;
+    long long black_nodes = 0;
+    long long white_nodes = 0;
+};
+
+// ============================================================================
+// تخمین Elo و آزمون SPRT
+// ============================================================================
+
+struct MatchEstimate {
+    int games = 0;
+    double score = 0.5;      // امتیاز میانگین (برد 1، مساوی 0.5)
+    double variance = 0.0;   // واریانس امتیاز یک بازی
+    double elo = 0.0;
+    double elo_low = 0.0;
+    double elo_high = 0.0;
+};
+
+// تبدیل امتیاز به اختلاف Elo (مدل لجستیک)
+double scoreToElo(double score) {
+    score = min(max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+double eloToScore(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// تخمین سه‌جمله‌ای: برد/مساوی/باخت و بازه اطمینان 95٪
+MatchEstimate estimateMatch(int wins, int draws, int losses) {
+    MatchEstimate estimate;
+    estimate.games = wins + draws + losses;
+    if (estimate.games == 0) {
+        return estimate;
+    }
+
+    double n = estimate.games;
+    double s = (wins + 0.5 * draws) / n;
+    estimate.score = s;
+    estimate.variance = (wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) +
+                         losses * s * s) / n;
+
+    double margin = 1.959964 * sqrt(estimate.variance / n);
+    estimate.elo = scoreToElo(s);
+    estimate.elo_low = scoreToElo(s - margin);
+    estimate.elo_high = scoreToElo(s + margin);
+    return estimate;
+}
+
+// لگاریتم نسبت درست‌نمایی SPRT (تقریب نرمال) برای H1: elo1 در برابر H0: elo0
+double sprtLLR(const MatchEstimate& estimate, double elo0, double elo1) {
+    if (estimate.games == 0 || estimate.variance <= 0.0) {
+        return 0.0;
+    }
+    double s0 = eloToScore(elo0);
+    double s1 = eloToScore(elo1);
+    return estimate.games * (s1 - s0) * (2.0 * estimate.score - s0 - s1) / (2.0 * estimate.variance);
+}
+
+// ============================================================================
+// عامل گونه‌های دیگر قواعد (8x8 انگلیسی، شاه پرنده)
+// ============================================================================
+
+// عامل‌ها و ارزیاب‌های آموخته (learned، NNUE، تجربه LearningAgent) به چیدمان 18 خانه‌ای
+// 6x6 بسته‌اند؛ برای گونه‌های دیگر فقط random، greedy و minimax روی ارزیاب‌های قالبی
+// evaluateBasic/evaluateAdvanced در دسترس‌اند
+template<class Game>
+class VariantAgent {
+private:
+    string type;
+    PieceType player;
+    int depth;
+    bool use_alpha_beta;
+    Xoshiro256 rng;
+    long long nodes = 0;
+
+    static constexpr double WIN_SCORE = 10000.0;
+
+    // negamax از دید بازیکن در نوبت؛ برد سریع‌تر امتیاز بیشتری دارد
+    double search(const Game& game, int remaining, double alpha, double beta) {
+        nodes++;
+        if (game.isGameOver()) {
+            PieceType winner = game.getWinner();
+            if (winner == PieceType::EMPTY) {
+                return 0.0;
+            }
+            return winner == game.getCurrentPlayer() ? WIN_SCORE + remaining : -WIN_SCORE - remaining;
+        }
+        if (remaining == 0) {
+            return MinimaxAgent::evaluateAdvanced(game, game.getCurrentPlayer());
+        }
+
+        double best = -numeric_limits<double>::infinity();
+        for (const auto& move : game.getAllValidMoves(game.getCurrentPlayer())) {
+            Game child = game.copy();
+            child.applyMove(move);
+            best = max(best, -search(child, remaining - 1, -beta, -alpha));
+            if (use_alpha_beta) {
+                alpha = max(alpha, best);
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+public:
+    VariantAgent(const string& t, PieceType p, int d, bool ab, uint64_t seed)
+        : type(t), player(p), depth(max(1, d)), use_alpha_beta(ab), rng(seed) {}
+
+    static bool supports(const string& t) {
+        return t == "random" || t == "greedy" || t == "minimax";
+    }
+
+    // گره‌های آخرین حرکت
+    long long lastNodes() const { return nodes; }
+
+    Move getMove(const Game& game) {
+        nodes = 0;
+        vector<Move> moves = game.getAllValidMoves(player);
+        if (moves.empty()) {
+            return Move();
+        }
+        if (type == "random") {
+            return moves[rng.below(moves.size())];
+        }
+
+        const Move* best_move = &moves[0];
+        double best_value = -numeric_limits<double>::infinity();
+        for (const auto& move : moves) {
+            Game child = game.copy();
+            child.applyMove(move);
+            double value;
+            if (type == "greedy") {
+                nodes++;
+                value = MinimaxAgent::evaluateBasic(child, player);
+            } else {
+                value = -search(child, depth - 1, -numeric_limits<double>::infinity(),
+                                use_alpha_beta ? -best_value : numeric_limits<double>::infinity());
+            }
+            if (value > best_value) {
+                best_value = value;
+                best_move = &move;
+            }
+        }
+        return *best_move;
+    }
+};
+
+// ============================================================================
+// کلاس مدیریت بازی
+// ============================================================================
+
+class GameManager {
+private:
+    CheckersGame game;
+    unique_ptr<CheckersAgent> agent1; // سیاه
+    unique_ptr<CheckersAgent> agent2; // سفید
+    string game_mode;
+    
+    // گره‌های جستجو شده در بازی جاری (0: سیاه، 1: سفید)
+    array<long long, 2> game_nodes{};
+    bool log_search_stats = false;
+    
+    // تأخیر و گره‌های هر حرکت در تورنمنت جاری
+    array<AgentMoveLog, 2> move_logs;
+    vector<MoveRecord> move_records;
+    int current_game_index = 0;
+    string results_base = "experiment_results";
+    
+    // فایل تجربه عامل‌های learning
+    string experience_file = "checkers_experience.dat";
+    
+    // بذر اصلی؛ بذر عامل‌های هر بازی از آن مشتق می‌شود
+    uint64_t master_seed = 1;
+    
+    bool pondering = false;
+    
+public:
+    GameManager() : game() {}
+    
+    void setMasterSeed(uint64_t seed) { master_seed = seed; }
+    uint64_t getMasterSeed() const { return master_seed; }
+    
+    // بذر قطعی عامل یک رنگ در بازی جاری
+    uint64_t agentSeed(PieceType player) const {
+        return deriveSeed(master_seed, current_game_index * 2 + (player == PieceType::BLACK_PIECE ? 0 : 1));
+    }
+    
+    // پیشوند فایل‌های خروجی runExperiments (خالی: بدون فایل)
+    void setResultsOutput(const string& base) { results_base = base; }
+    const array<AgentMoveLog, 2>& getMoveLogs() const { return move_logs; }
+    
+    // لاگ JSON آمار جستجو برای هر حرکت عامل‌های Minimax
+    void setSearchLogging(bool enabled) { log_search_stats = enabled; }
+    
+    void setExperienceFile(const string& file) { experience_file = file; }
+    
+    // تنظیم بازی
+    void setupGame(const string& mode = "human_vs_agent", 
+                   const string& agent1_type = "minimax",
+                   const string& agent2_type = "random",
+                   int depth = 3, bool use_alpha_beta = true) {
+        game_mode = mode;
+        
+        if (mode == "human_vs_agent") {
+            agent1 = nullptr; // انسان
+            agent2 = createAgent(agent2_type, PieceType::WHITE_PIECE, depth, use_alpha_beta);
+        } else if (mode == "human_vs_human") {
+            agent1 = nullptr;
+            agent2 = nullptr;
+        } else if (mode == "agent_vs_agent") {
+            agent1 = createAgent(agent1_type, PieceType::BLACK_PIECE, depth, use_alpha_beta);
+            agent2 = createAgent(agent2_type, PieceType::WHITE_PIECE, depth, use_alpha_beta);
+        }
+        
+        for (CheckersAgent* agent : {agent1.get(), agent2.get()}) {
+            if (auto minimax_agent = dynamic_cast<MinimaxAgent*>(agent)) {
+                minimax_agent->setStatsLogging(log_search_stats);
+                minimax_agent->setHardwareCounters(log_search_stats || TRACING);
             }
-        } else {
-            board[final_pos.row][final_pos.col] = piece;
         }
         
-        // ذخیره در تاریخچه
-        move_history.push_back(move);
-        
-        // تغییر نوبت
-        current_player = (current_player == PieceType::BLACK_PIECE) ? 
-                        PieceType::WHITE_PIECE : PieceType::BLACK_PIECE;
-        
-        // بررسی پایان بازی
-        checkGameOver();
-        
-        return true;
+        // در بازی با انسان، عامل در زمان فکر کردن انسان جستجو می‌کند
+        pondering = (mode == "human_vs_agent");
     }
     
-    // بررسی پایان بازی
-    void checkGameOver() {
-        int black_count = 0;
-        int white_count = 0;
-        
-        // شمارش مهره‌ها
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                PieceType piece = board[i][j];
-                if (piece == PieceType::BLACK_PIECE || piece == PieceType::BLACK_KING) {
-                    black_count++;
-                } else if (piece == PieceType::WHITE_PIECE || piece == PieceType::WHITE_KING) {
-                    white_count++;
-                }
-            }
+    // ایجاد عامل
+    unique_ptr<CheckersAgent> createAgent(const string& full_type, PieceType player, 
+                                         int depth, bool use_alpha_beta) {
+        // پسوندهای جستجوی انتخابی: مثلاً minimax+lmr+futility یا selective (همه)
+        string type = full_type.substr(0, full_type.find('+'));
+        SearchOptions options;
+        options.lmr = full_type.find("+lmr") != string::npos;
+        options.futility = full_type.find("+futility") != string::npos;
+        options.probcut = full_type.find("+probcut") != string::npos;
+        if (type == "selective") {
+            type = "minimax";
+            options.lmr = options.futility = options.probcut = true;
         }
         
-        // اگر یکی از بازیکنان مهره‌ای نداشته باشد
-        if (black_count == 0) {
-            game_over = true;
-            winner = PieceType::WHITE_PIECE;
-            return;
+        unique_ptr<CheckersAgent> agent = createBaseAgent(type, player, depth, use_alpha_beta);
+        if (type == "minimax" && !options.suffix().empty()) {
+            static_cast<MinimaxAgent*>(agent.get())->setSearchOptions(options);
+        }
+        return agent;
+    }
+    
+    unique_ptr<CheckersAgent> createBaseAgent(const string& type, PieceType player,
+                                             int depth, bool use_alpha_beta) {
+        if (type == "random") {
+            return make_unique<RandomAgent>(player, agentSeed(player));
+        } else if (type == "greedy") {
+            return make_unique<GreedyAgent>(player);
+        } else if (type == "minimax") 
+        {
+            return make_unique<MinimaxAgent>(player, depth, use_alpha_beta, "advanced");
+        } else if (type == "learning") {
+            return make_unique<LearningAgent>(player, depth, use_alpha_beta, "advanced", 0.1, experience_file);
+        } else if (type == "learned") {
+            return make_unique<MinimaxAgent>(player, depth, use_alpha_beta, "learned");
+        } else if (type == "nnue") {
+            return make_unique<MinimaxAgent>(player, depth, use_alpha_beta, "nnue");
+        } else if (type == "mcts") {
+            // بودجه شبیه‌سازی متناسب با عمق درخواستی؛ یک نخ، چون رشد درخت با چند نخ به
+            // زمان‌بندی نخ‌ها بستگی دارد و بازی‌ها با همان بذر تکرار نمی‌شوند
+            return make_unique<MCTSAgent>(player, 500 * depth, 0, 1, "random", 1.41, 1000000,
+                                          agentSeed(player));
         }
+        return make_unique<RandomAgent>(player, agentSeed(player)); // پیش‌فرض
+    }
+    
+    // اجرای یک بازی کامل
+    void playGame(bool display = true, const vector<Move>& opening = {}) {
+        game = CheckersGame();
+        vector<Move> game_history;
+        game_nodes = {0, 0};
         
-        if (white_count == 0) {
-            game_over = true;
-            winner = PieceType::BLACK_PIECE;
-            return;
+        // اعمال حرکات گشایش (برای مسابقه‌های آماری)
+        for (const auto& move : opening) {
+            game.applyMove(move);
         }
         
-        // بررسی حرکت معتبر برای بازیکن فعلی
-        vector<Move> valid_moves = getAllValidMoves(current_player);
-        if (valid_moves.empty()) {
-            game_over = true;
-            winner = (current_player == PieceType::BLACK_PIECE) ? 
-                    PieceType::WHITE_PIECE : PieceType::BLACK_PIECE;
-            return;
+        if (display) {
+            cout << "start checker" << endl;
+            game.printBoard();
         }
         
-        // جلوگیری از حلقه بی‌نهایت
-        if (move_history.size() >= 30) {
-            int recent_captures = 0;
-            int start_idx = move_history.size() > 30 ? move_history.size() - 30 : 0;
+        while (!game.isGameOver()) {
+            string player_name = (game.getCurrentPlayer() == PieceType::BLACK_PIECE) ? 
+                               "black" :"white";
             
-            for (size_t i = start_idx; i < move_history.size(); i++) {
-                if (move_history[i].is_capture) {
-                    recent_captures++;
-                }
+            if (display) {
+                cout << "\n player " << player_name << endl;
             }
             
-            if (recent_captures == 0) {
-                game_over = true;
-                winner = PieceType::EMPTY; // مساوی
-                return;
+            // دریافت حرکت
+            Move move;
+            if (game.getCurrentPlayer() == PieceType::BLACK_PIECE) {move = getAgentMove(agent1.get(), PieceType::BLACK_PIECE, display);
+            } else {
+                move = getAgentMove(agent2.get(), PieceType::WHITE_PIECE, display);
             }
-        }
-        
-        game_over = false;
-    }
-    
-    // نمایش صفحه
-    void printBoard() const {
-        cout << "  0 1 2 3 4 5" << endl;
-        
-        for (int row = BOARD_SIZE - 1; row >= 0; row--) {
-            cout << row << " ";
-            for (int col = 0; col < BOARD_SIZE; col++) {
-                Position pos(row, col);
-                if (!isBlackSquare(pos)) {
-                    cout << "██";
-                } else {
-                    switch (board[row][col]) {
-                        case PieceType::EMPTY:
-                            cout << "  ";
-                            break;
-                        case PieceType::BLACK_PIECE:
-                            cout << "● ";
-                            break;
-                        case PieceType::WHITE_PIECE:
-                            cout << "○ ";
-                            break;
-                        case PieceType::BLACK_KING:
-                            cout << "♔ ";
-                            break;
-                        case PieceType::WHITE_KING:
-                            cout << "♕ ";
-                            break;
-                        default:
-                            cout << "  ";
-                    }
+            
+            if (move.to.empty()) {
+                cout << "هیچ حرکت معتبری وجود ندارد!" << endl;
+                break;
+            }
+            
+            // ذخیره وضعیت قبل از حرکت برای یادگیری
+            move.board_before = game.getBoardKey();
+            game_history.push_back(move);
+            // اعمال حرکت
+            bool black_moved = game.getCurrentPlayer() == PieceType::BLACK_PIECE;
+            game.applyMove(move);
+            
+            // ponder عامل تا زمانی که انسان حرکت خود را انتخاب کند
+            CheckersAgent* mover = black_moved ? agent1.get() : agent2.get();
+            CheckersAgent* opponent = black_moved ? agent2.get() : agent1.get();
+            if (pondering && mover != nullptr && opponent == nullptr && !game.isGameOver()) {
+                mover->startPondering(game);
+            }
+            
+            if (display) {
+                cout << "move from" << move.from.row << "," << move.from.col 
+                     << "to" << move.to.back().row << "," << move.to.back().col << ")" << endl;
+                
+                if (!move.captured.empty()) {
+                    cout << "delete checkers ";
+                    for (const auto& cap : move.captured) {
+                        cout << "(" << cap.row << "," << cap.col << ") ";
+                    }cout << endl;
                 }
+                
+                game.printBoard();
             }
-            cout << " " << row << endl;
         }
-        cout << "  0 1 2 3 4 5" << endl;
-    }
-    
-    // دریافت کلید صفحه برای یادگیری
-    string getBoardKey() const {
-        string key;
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                key += to_string(static_cast<int>(board[i][j]));
+        
+        for (CheckersAgent* agent : {agent1.get(), agent2.get()}) {
+            if (agent != nullptr) {
+                agent->stopPondering();
             }
         }
-        return key;
-    }
-    
-    // getterها
-    bool isGameOver() const { return game_over; }
-    PieceType getWinner() const { return winner; }
-    PieceType getCurrentPlayer() const { return current_player; }
-    const array<array<PieceType, BOARD_SIZE>, BOARD_SIZE>& getBoard() const { return board; }
-    const vector<Move>& getMoveHistory() const { return move_history; }
-    
-    // ایجاد کپی
-    CheckersGame copy() const {
-        return CheckersGame(*this);
-    }
-};
-
-// تعریف static member
-mt19937 CheckersGame::rng(chrono::steady_clock::now().time_since_epoch().count());
-
-// ============================================================================
-// کلاس پایه عامل
-// ============================================================================
-
-class CheckersAgent {
-protected:
-    PieceType player;
-    string name;
-    
-public:
-    CheckersAgent(PieceType p, string n = "Base Agent") : player(p), name(n) {}
-    virtual ~CheckersAgent() = default;
-    
-    virtual Move getMove(const CheckersGame& game) = 0;
-    
-    string getName() const { return name; }
-    PieceType getPlayer() const { return player; }
-};
-
-// ============================================================================
-// عامل تصادفی
-// ============================================================================
-
-class RandomAgent : public CheckersAgent {
-private:
-    mt19937 rng;
-    
-public:
-    RandomAgent(PieceType p) : CheckersAgent(p, "Random Agent") {
-        rng.seed(chrono::steady_clock::now().time_since_epoch().count());
+        
+        // نمایش نتیجه
+        if (display) {
+            PieceType winner = game.getWinner();
+            if (winner == PieceType::EMPTY) {
+                cout << "\n draw" << endl;
+            } else {
+                string winner_name = (winner == PieceType::BLACK_PIECE) ? "black" : "white";
+                cout << "\n player " << winner_name <<"win" << endl;}
+        }
+        double black_result = 0.0;
+        if (game.getWinner() == PieceType::BLACK_PIECE) black_result = 1.0;
+        else if (game.getWinner() == PieceType::WHITE_PIECE) black_result = -1.0;
+        
+        if (auto learning_agent = dynamic_cast<LearningAgent*>(agent1.get())) {
+            learning_agent->learnFromGame(game_history, black_result);
+        }
+        
+        if (auto learning_agent = dynamic_cast<LearningAgent*>(agent2.get())) {
+            learning_agent->learnFromGame(game_history, -black_result);
+        }
     }
-    
-    Move getMove(const CheckersGame& game) override {
+    // دریافت حرکت از عامل یا انسان
+    Move getAgentMove(CheckersAgent* agent, PieceType player, bool display) {
         vector<Move> moves = game.getAllValidMoves(player);
         
         if (moves.empty()) {
             return Move();
         }
         
-        uniform_int_distribution<int> dist(0, moves.size() - 1);
-        return moves[dist(rng)];
+        if (agent == nullptr) { // حرکت انسان
+            if (display) {
+                cout << "moves:"<< endl;
+                for (size_t i = 0; i < moves.size(); i++) {
+                    const auto& move = moves[i];
+                    cout << i << ": from" << move.from.row << "," << move.from.col 
+                         << "to" << move.to.back().row << "," << move.to.back().col << ") ";
+                    cout << (move.is_capture ? "(capture)" : "(basic)") << endl;
+                }
+            }
+            
+            int choice;
+            while (true) {
+                cout << "choose number";
+                cin >> choice;
+                
+                if (choice >= 0 && choice < static_cast<int>(moves.size())) {return moves[choice];
+                } else {
+                    cout << "شماره حرکت نامعتبر است." << endl;
+                }
+            }
+        } else { // حرکت عامل
+            if (display) {
+                cout << agent->getName() << " in calculation" << endl;
+            }
+            
+            auto start = chrono::steady_clock::now();
+            Move move = agent->getMove(game);
+            auto end = chrono::steady_clock::now();
+            auto duration = chrono::duration_cast<chrono::microseconds>(end - start);
+            
+            // ثبت تأخیر و گره‌های این حرکت
+            int side = (player == PieceType::BLACK_PIECE) ? 0 : 1;
+            long long nodes = 0;
+            auto minimax_agent = dynamic_cast<MinimaxAgent*>(agent);
+            if (minimax_agent) {
+                nodes = minimax_agent->getLastSearchStats().nodes;
+            } else if (auto mcts_agent = dynamic_cast<MCTSAgent*>(agent)) {
+                nodes = mcts_agent->getPlayoutCount();
+            }
+            game_nodes[side] += nodes;
+            recordMove({current_game_index, static_cast<int>(game.getMoveHistory().size()),
+                        side, duration.count(), nodes});
+            
+            if (display) {
+                cout << "time of calculation:" << duration.count() / 1000.0 << " mlsecend" << endl;
+                
+                if (minimax_agent) {
+                    const SearchStats& stats = minimax_agent->getLastSearchStats();
+                    cout << "number of nudes " 
+                         << minimax_agent->getNodesExpanded() << endl;
+                    cout << "nps: " << static_cast<long long>(stats.nps())
+                         << ", first-move cutoff rate: " << stats.firstMoveCutoffRate()
+                         << ", ponder hits: " << minimax_agent->getPonderHits() << endl;
+                }
+            }
+            
+            return move;}
+    }
+    // ساخت مجموعه گشایش‌های تصادفی (plies حرکت تصادفی از شروع)
+    vector<vector<Move>> makeOpenings(int count, int plies, uint64_t seed) {
+        vector<vector<Move>> openings;
+        Xoshiro256 rng(deriveSeed(seed, 0));
+        int attempts = 0;
+        
+        while (static_cast<int>(openings.size()) < count && attempts < count * 20) {
+            attempts++;
+            CheckersGame opening_game;
+            vector<Move> opening;
+            for (int ply = 0; ply < plies && !opening_game.isGameOver(); ply++) {
+                vector<Move> moves = opening_game.getAllValidMoves(opening_game.getCurrentPlayer());
+                if (moves.empty()) break;
+                Move move = moves[rng.below(moves.size())];
+                opening.push_back(move);
+                opening_game.applyMove(move);
+            }
+            if (!opening_game.isGameOver() && static_cast<int>(opening.size()) == plies) {
+                openings.push_back(opening);
+            }
+        }
+        return openings;
     }
-};
-
-// ============================================================================
-// عامل حریصانه
-// ============================================================================
-
-class GreedyAgent : public CheckersAgent {
-public:
-    GreedyAgent(PieceType p) : CheckersAgent(p, "Greedy Agent") {}
     
-    Move getMove(const CheckersGame& game) override {
-        vector<Move> moves = game.getAllValidMoves(player);
+    // مسابقه آماری بین دو عامل: جفت بازی با رنگ‌های جابجا روی هر گشایش،
+    // تخمین Elo با بازه اطمینان 95٪ و توقف زودهنگام SPRT
+    void runMatch(const string& agent_a, const string& agent_b, int max_games = 400,
+                  int depth_a = 3, int depth_b = 3, double elo0 = 0.0, double elo1 = 20.0,
+                  double alpha = 0.05, double beta = 0.05, int opening_plies = 4,
+                  uint64_t seed = 1) {
+        master_seed = seed;
+        int wins = 0, draws = 0, losses = 0;   // از دید عامل A
+        double lower_bound = log(beta / (1.0 - alpha));
+        double upper_bound = log((1.0 - beta) / alpha);
+        string verdict = "inconclusive";
         
-        if (moves.empty()) {
-            return Move();
+        int num_pairs = (max_games + 1) / 2;
+        vector<vector<Move>> openings = makeOpenings(num_pairs, opening_plies, seed);
+        if (openings.empty()) {
+            cout << "no openings could be generated" << endl;
+            return;
         }
         
-        // پیدا کردن حرکت با بیشترین capture
-        Move best_move = moves[0];
-        for (const auto& move : moves) {
-            if (move.capture_count > best_move.capture_count) {
-                best_move = move;
+        cout << "match " << agent_a << " (d=" << depth_a << ") vs " << agent_b << " (d=" << depth_b
+             << "), max " << max_games << " games, SPRT elo0=" << elo0 << " elo1=" << elo1
+             << " alpha=" << alpha << " beta=" << beta << ", openings=" << openings.size()
+             << " x " << opening_plies << " plies, seed=" << seed << endl;
+        
+        int games_played = 0;
+        double llr = 0.0;
+        for (int pair = 0; games_played < max_games; pair++) {
+            const vector<Move>& opening = openings[pair % openings.size()];
+            
+            // هر گشایش دو بار: A با سیاه و A با سفید
+            for (int a_is_black = 1; a_is_black >= 0 && games_played < max_games; a_is_black--) {
+                current_game_index = games_played + 1;
+                if (a_is_black) {
+                    agent1 = createAgent(agent_a, PieceType::BLACK_PIECE, depth_a, true);
+                    agent2 = createAgent(agent_b, PieceType::WHITE_PIECE, depth_b, true);
+                } else {
+                    agent1 = createAgent(agent_b, PieceType::BLACK_PIECE, depth_b, true);
+                    agent2 = createAgent(agent_a, PieceType::WHITE_PIECE, depth_a, true);
+                }
+                playGame(false, opening);
+                games_played++;
+                
+                PieceType a_color = a_is_black ? PieceType::BLACK_PIECE : PieceType::WHITE_PIECE;
+                PieceType winner = game.getWinner();
+                if (winner == PieceType::EMPTY) {
+                    draws++;
+                } else if (winner == a_color) {
+                    wins++;
+                } else {
+                    losses++;
+                }
+            }
+            
+            MatchEstimate estimate = estimateMatch(wins, draws, losses);
+            llr = sprtLLR(estimate, elo0, elo1);
+            cout << "games " << games_played << ": +" << wins << " =" << draws << " -" << losses
+                 << " elo " << estimate.elo << " [" << estimate.elo_low << ", " << estimate.elo_high
+                 << "] LLR " << llr << " (" << lower_bound << ", " << upper_bound << ")" << endl;
+            
+            if (llr >= upper_bound) {
+                verdict = "H1 accepted (A stronger by >= elo1)";
+                break;
+            }
+            if (llr <= lower_bound) {
+                verdict = "H0 accepted (A not stronger than elo0)";
+                break;
             }
         }
         
-        return best_move;
+        MatchEstimate estimate = estimateMatch(wins, draws, losses);
+        cout << "\nmatch result: " << agent_a << " vs " << agent_b << ": +" << wins << " =" << draws
+             << " -" << losses << " score " << estimate.score * 100.0 << "%" << endl;
+        cout << "elo difference: " << estimate.elo << " (95% CI " << estimate.elo_low << " .. "
+             << estimate.elo_high << ")" << endl;
+        cout << "SPRT: " << verdict << ", LLR " << llr << " after " << games_played << " games" << endl;
     }
-};
-
-// ============================================================================
-// عامل Minimax
-// ============================================================================
-
-class MinimaxAgent : public CheckersAgent {
-protected:
-    int depth;
-    bool use_alpha_beta;
-    string eval_func;
-    int nodes_expanded;
     
-    // تعریف تابع ارزیابی
-    using EvalFunc = function<double(const CheckersGame&, PieceType)>;
-    unordered_map<string, EvalFunc> eval_functions;
+    // ثبت یک حرکت در آمار تورنمنت (حرکت‌های همین پردازه یا گزارش کارگرها)
+    void recordMove(const MoveRecord& record) {
+        move_logs[record.side].latency.record(record.latency_us);
+        move_logs[record.side].total_nodes += record.nodes;
+        move_logs[record.side].moves++;
+        move_records.push_back(record);
+    }
     
-public:
-    MinimaxAgent(PieceType p, int d =3, bool ab = true, string ef = "basic") 
-        : CheckersAgent(p, "Minimax Agent"), depth(d), use_alpha_beta(ab), 
-          eval_func(ef), nodes_expanded(0) {
+    // حرکت‌های ثبت‌شده از آخرین فراخوانی (برای ارسال به هماهنگ‌کننده)
+    vector<MoveRecord> takeMoveRecords() {
+        vector<MoveRecord> records;
+        records.swap(move_records);
+        return records;
+    }
+    
+    // شروع تورنمنت تازه: آمار حرکت‌ها پاک می‌شود
+    void beginExperiments(const string& agent1_type, const string& agent2_type) {
+        move_records.clear();
+        move_logs[0].clear(agent1_type);
+        move_logs[1].clear(agent2_type);
+    }
+    
+    // یک بازی تورنمنت؛ بذر عامل‌ها از شماره بازی مشتق می‌شود، پس نتیجه به ترتیب
+    // اجرا (یا پردازه اجراکننده) بستگی ندارد
+    ExperimentGame playExperimentGame(int game_index, const string& agent1_type,
+                                      const string& agent2_type, int depth, bool use_alpha_beta) {
+        current_game_index = game_index;
+        setupGame("agent_vs_agent", agent1_type, agent2_type, depth, use_alpha_beta);
+        playGame(false);
         
-        name = "Minimax (d=" + to_string(depth) + ", AB=" + (use_alpha_beta ? "Y" : "N") + ")";
+        ExperimentGame row;
+        row.game = game_index;
+        row.winner = static_cast<int>(game.getWinner());
+        row.moves = static_cast<int>(game.getMoveHistory().size());
+        row.black_nodes = game_nodes[0];
+        row.white_nodes = game_nodes[1];
+        return row;
+    }
+    
+    static void printGameResult(const ExperimentGame& row, const string& agent1_type,
+                                const string& agent2_type) {
+        if (row.winner == 1) {
+            cout << "  result: " << agent1_type << " (black) wins";
+        } else if (row.winner == 2) {
+            cout << "  result: " << agent2_type << " (white) wins";
+        } else {
+            cout << "  draw";
+        }
+        cout << " (" << row.moves << " move" << endl;
+    }
+    
+    // اجرای آزمایش‌های تجربی
+    void runExperiments(int num_games = 10, const string& agent1_type = "minimax",
+                       const string& agent2_type = "random", int depth = 3,
+                       bool use_alpha_beta = true) {
+        vector<ExperimentGame> games;
+        beginExperiments(agent1_type, agent2_type);
+        auto tournament_start = chrono::steady_clock::now();
+        cout  << num_games << " game between " 
+             << agent1_type << " black and" << agent2_type << " (white)" << endl;
+        cout << "depth search: " << depth << ", Alpha-Beta: " 
+             << (use_alpha_beta ? "active" : "inactive") << ", seed: " << master_seed << endl;
         
-        // ثبت توابع ارزیابی
-        eval_functions["basic"] = [this](const CheckersGame& game, PieceType player) {
-            return evaluateBasic(game, player);
-        };
-        eval_functions["advanced"] = [this](const CheckersGame& game, PieceType player) {
-            return evaluateAdvanced(game, player);
-        };
+        for (int game_num = 0; game_num < num_games; game_num++) {
+            cout << "\n number game" << game_num + 1 << ":" << endl;
+            games.push_back(playExperimentGame(game_num + 1, agent1_type, agent2_type, depth, use_alpha_beta));
+            printGameResult(games.back(), agent1_type, agent2_type);
+        }
         
-        eval_functions["positional"] = [this](const CheckersGame& game, PieceType player) {
-            return evaluatePositional(game, player);
-        };
+        double elapsed_s = chrono::duration<double>(chrono::steady_clock::now() - tournament_start).count();
+        reportExperiments(games, agent1_type, agent2_type, depth, use_alpha_beta, elapsed_s);
     }
     
-    virtual Move getMove(const CheckersGame& game) override {
-        nodes_expanded = 0;
-        vector<Move> moves = game.getAllValidMoves(player);
-        if (moves.empty()) {
-            return Move();
+    // تورنمنت روی گونه‌ای دیگر از قواعد (8x8، شاه پرنده) با VariantAgent؛ همان خلاصه و خروجی
+    template<class Game>
+    void runVariantExperiments(int num_games, const string& agent1_type, const string& agent2_type,
+                               int depth, bool use_alpha_beta) {
+        const string variant = Game::RuleSet::NAME;
+        if (!VariantAgent<Game>::supports(agent1_type) || !VariantAgent<Game>::supports(agent2_type)) {
+            cout << "variant " << variant << " supports agent types random, greedy and minimax" << endl;
+            return;
         }
         
-        Move best_move;
-        double best_value = -numeric_limits<double>::infinity();
+        vector<ExperimentGame> games;
+        beginExperiments(agent1_type, agent2_type);
+        auto tournament_start = chrono::steady_clock::now();
+        cout << num_games << " game between " << agent1_type << " black and " << agent2_type
+             << " (white), variant " << variant << endl;
+        cout << "depth search: " << depth << ", Alpha-Beta: "
+             << (use_alpha_beta ? "active" : "inactive") << ", seed: " << master_seed << endl;
         
-        // ارزیابی هر حرکت
-        for (const auto& move : moves) {
-            CheckersGame game_copy = game.copy();
-            game_copy.applyMove(move);
+        for (int game_num = 0; game_num < num_games; game_num++) {
+            current_game_index = game_num + 1;
+            VariantAgent<Game> black(agent1_type, PieceType::BLACK_PIECE, depth, use_alpha_beta,
+                                     agentSeed(PieceType::BLACK_PIECE));
+            VariantAgent<Game> white(agent2_type, PieceType::WHITE_PIECE, depth, use_alpha_beta,
+                                     agentSeed(PieceType::WHITE_PIECE));
+            Game variant_game;
+            ExperimentGame row;
+            row.game = current_game_index;
             
-            double value;
-            if (use_alpha_beta) {
-                value = alphaBeta(game_copy, depth - 1, 
-                                 -numeric_limits<double>::infinity(),
-                                 numeric_limits<double>::infinity(), false);
-            } else {
-                value = minimax(game_copy, depth - 1, false);
+            while (!variant_game.isGameOver()) {
+                int side = variant_game.getCurrentPlayer() == PieceType::BLACK_PIECE ? 0 : 1;
+                VariantAgent<Game>& agent = side == 0 ? black : white;
+                auto move_start = chrono::steady_clock::now();
+                Move move = agent.getMove(variant_game);
+                long long latency_us = chrono::duration_cast<chrono::microseconds>(
+                    chrono::steady_clock::now() - move_start).count();
+                if (move.to.empty()) {
+                    break;
+                }
+                variant_game.applyMove(move);
+                (side == 0 ? row.black_nodes : row.white_nodes) += agent.lastNodes();
+                recordMove({row.game, row.moves, side, latency_us, agent.lastNodes()});
+                row.moves++;
             }
+            row.winner = static_cast<int>(variant_game.getWinner());
             
-            if (value > best_value) {
-                best_value = value;
-                best_move = move;
-            }
+            cout << "\n number game" << row.game << ":" << endl;
+            games.push_back(row);
+            printGameResult(row, agent1_type, agent2_type);
         }
         
-        return best_move;
+        double elapsed_s = chrono::duration<double>(chrono::steady_clock::now() - tournament_start).count();
+        reportExperiments(games, agent1_type, agent2_type, depth, use_alpha_beta, elapsed_s,
+                          ", \"variant\": \"" + variant + "\"");
     }
-    // الگوریتم Minimax استاندارد
-    double minimax(CheckersGame& game, int depth, bool maximizing_player) {
-        nodes_expanded++;
+    
+    // خلاصه تورنمنت و خروجی JSON/CSV از بازی‌ها و حرکت‌های ثبت‌شده؛
+    // extra_summary (مثلاً آمار کارگرها) به بخش summary افزوده می‌شود
+    void reportExperiments(const vector<ExperimentGame>& games, const string& agent1_type,
+                           const string& agent2_type, int depth, bool use_alpha_beta,
+                           double elapsed_s, const string& extra_summary = "") {
+        struct Results {
+            int black_wins = 0;
+            int white_wins = 0;
+            int draws = 0;
+            double avg_moves = 0;
+            long long total_nodes = 0;
+            long long black_nodes = 0;
+            long long white_nodes = 0;
+        } results;
         
-        if (depth == 0 || game.isGameOver()) {
-            return evaluate(game);
+        const int num_games = static_cast<int>(games.size());
+        for (const ExperimentGame& row : games) {
+            if (row.winner == 1) {
+                results.black_wins++;
+            } else if (row.winner == 2) {
+                results.white_wins++;
+            } else {
+                results.draws++;
+            }
+            results.avg_moves += row.moves;
+            // جمع‌آوری تعداد گره‌ها (همه حرکات هر دو عامل)
+            results.black_nodes += row.black_nodes;
+            results.white_nodes += row.white_nodes;
+            results.total_nodes += row.black_nodes + row.white_nodes;
         }
         
-        PieceType current_player = game.getCurrentPlayer();
-        vector<Move> moves = game.getAllValidMoves(current_player);
+        // محاسبه میانگین‌ها
+        if (num_games > 0) {
+            results.avg_moves /= num_games;
+        }
+        // نمایش نتایج کلی
+        cout << "\n results:" << endl;
+        cout << "black wins" << agent1_type << "): " << results.black_wins << endl;
+        cout << "white wins:" << agent2_type << "): " << results.white_wins << endl;
+        cout << "numbers of draws" << results.draws << endl;
+        cout << "mean of moves:" << results.avg_moves << endl;
         
-        if (maximizing_player) {
-            double max_eval = -numeric_limits<double>::infinity();
-            for (const auto& move : moves) {CheckersGame game_copy = game.copy();
-                game_copy.applyMove(move);
-                double eval = minimax(game_copy, depth - 1, false);
-                max_eval = max(max_eval, eval);
-            }
-            return max_eval;
-        } else {
-            double min_eval = numeric_limits<double>::infinity();
-            for (const auto& move : moves) {
-                CheckersGame game_copy = game.copy();
-                game_copy.applyMove(move);
-                double eval = minimax(game_copy, depth - 1, true);
-                min_eval = min(min_eval, eval);
-            }
-            return min_eval;
+        if (results.total_nodes > 0) {
+            cout << "mean nodes per game: " 
+                 << results.total_nodes / num_games
+                 << " (black " << results.black_nodes / num_games
+                 << ", white " << results.white_nodes / num_games << ")" << endl;
         }
-    }
-    
-    // الگوریتم Alpha-Beta Pruning
-    double alphaBeta(CheckersGame& game, int depth, double alpha, double beta, 
-                    bool maximizing_player) {
-        nodes_expanded++;
         
-        if (depth == 0 || game.isGameOver()) {
-            return evaluate(game);
+        // تأخیر هر حرکت به تفکیک عامل
+        for (const auto& log : move_logs) {
+            cout << "latency " << log.name << ": p50=" << log.latency.percentile(50)
+                 << "us p95=" << log.latency.percentile(95) << "us p99=" << log.latency.percentile(99)
+                 << "us max=" << log.latency.maximum() << "us nodes/move=" << log.nodesPerMove() << endl;
         }
         
-        PieceType current_player = game.getCurrentPlayer();
-        vector<Move> moves = game.getAllValidMoves(current_player);
+        if (results_base.empty()) {
+            return;
+        }
         
-        if (maximizing_player) {
-            double max_eval = -numeric_limits<double>::infinity();
-            for (const auto& move : moves) {
-                CheckersGame game_copy = game.copy();
-                game_copy.applyMove(move);
-                double eval = alphaBeta(game_copy, depth - 1, alpha, beta, false);
-                max_eval = max(max_eval, eval);
-                alpha = max(alpha, eval);
-                if (beta <= alpha) {
-                    break; // Beta cutoff
-                }
+        // خروجی JSON: پیکربندی، نتیجه کلی، آمار عامل‌ها و بازی‌ها
+        ofstream json(results_base + ".json");
+        if (json.is_open()) {
+            json << "{\n  \"config\": {\"games\": " << num_games << ", \"black\": \"" << agent1_type
+                 << "\", \"white\": \"" << agent2_type << "\", \"depth\": " << depth
+                 << ", \"alpha_beta\": " << (use_alpha_beta ? "true" : "false")
+                 << ", \"seed\": " << master_seed << "},\n"
+                 << "  \"summary\": {\"black_wins\": " << results.black_wins
+                 << ", \"white_wins\": " << results.white_wins << ", \"draws\": " << results.draws
+                 << ", \"avg_moves\": " << results.avg_moves << ", \"total_nodes\": " << results.total_nodes
+                 << ", \"elapsed_s\": " << elapsed_s << extra_summary << "},\n"
+                 << "  \"agents\": [\n    " << move_logs[0].toJson() << ",\n    "
+                 << move_logs[1].toJson() << "\n  ],\n  \"games\": [\n";
+            for (size_t g = 0; g < games.size(); g++) {
+                const ExperimentGame& row = games[g];
+                json << "    {\"game\": " << row.game << ", \"winner\": \""
+                     << (row.winner == 1 ? "black" : row.winner == 2 ? "white" : "draw")
+                     << "\", \"moves\": " << row.moves << ", \"black_nodes\": " << row.black_nodes
+                     << ", \"white_nodes\": " << row.white_nodes << "}"
+                     << (g + 1 < games.size() ? "," : "") << "\n";
             }
-            return max_eval;
-        } else {
-            double min_eval = numeric_limits<double>::infinity();
-            for (const auto& move : moves) {
-                CheckersGame game_copy = game.copy();
-                game_copy.applyMove(move);
-                double eval = alphaBeta(game_copy, depth - 1, alpha, beta, true);
-                min_eval = min(min_eval, eval);
-                beta = min(beta, eval);
-                if (beta <= alpha) {
-                    break; // Alpha cutoff
-                }
+            json << "  ]\n}\n";
+        }
+        
+        // خروجی CSV: یک سطر برای هر حرکت
+        ofstream csv(results_base + "_moves.csv");
+        if (csv.is_open()) {
+            csv << "game,ply,side,agent,latency_us,nodes\n";
+            for (const auto& record : move_records) {
+                csv << record.game << "," << record.ply << "," << (record.side == 0 ? "black" : "white")
+                    << "," << move_logs[record.side].name << "," << record.latency_us << ","
+                    << record.nodes << "\n";
             }
-            return min_eval;
         }
+        
+        cout << "results written to " << results_base << ".json and "
+             << results_base << "_moves.csv" << endl;
     }
+};
+// ============================================================================
+// اجرای چندپردازه‌ای: هماهنگ‌کننده محلی و کارگرها روی socketهای Unix
+// ============================================================================
+
+// هر کارگر پردازه‌ای fork‌شده با حافظه و جدول‌های خصوصی خودش است (تجربه LearningAgent،
+// جدول جابجایی) و با یک socketpair به هماهنگ‌کننده وصل است. پروتکل متنی و سطری است:
+//   هماهنگ‌کننده → "<job> <payload>" یا "quit"
+//   کارگر → سطرهای نتیجه، سپس "done <job>"
+// سطرهای هر کار تا "done" نگه داشته می‌شوند؛ اگر کارگر در میانه کار بمیرد (یا از مهلت
+// بگذرد و کشته شود) نتیجه ناقص دور ریخته می‌شود، کار دوباره در صف می‌رود و کارگر
+// تازه‌ای جای آن را می‌گیرد.
+#ifdef CHECKERS_HAVE_PROCESSES
+
+// کار یک کارگر: payload → سطرهای نتیجه (بدون '\n')
+using WorkerHandler = function<vector<string>(int job, const string& payload)>;
+// در هر پردازه کارگر یک بار با شماره کارگر صدا زده می‌شود؛ وضعیت خصوصی کارگر در handler
+// ساخته می‌شود. کارگر جایگزین همان شماره را می‌گیرد.
+using WorkerFactory = function<WorkerHandler(int worker_id)>;
+
+struct WorkerPoolOptions {
+    int workers = 2;
+    int max_restarts = 8;           // جایگزینی کارگرهای مرده در کل اجرا
+    int max_attempts = 2;           // کاری که این تعداد کارگر را از کار انداخت کنار گذاشته می‌شود
+    double job_timeout_s = 0.0;     // 0: بدون مهلت
+    bool pin = false;               // کارگر i روی CPU i؛ حافظه‌اش روی گره NUMA همان CPU تخصیص می‌یابد
+};
+
+struct WorkerPoolStats {
+    int completed = 0;
+    int failed = 0;
+    int restarts = 0;
+    int timeouts = 0;
+};
+
+class WorkerPool {
+private:
+    struct Worker {
+        int id = 0;
+        pid_t pid = -1;
+        int fd = -1;                // -1: کارگر زنده نیست
+        string buffer;              // بایت‌های خوانده‌شده تا پایان سطر
+        vector<string> lines;       // سطرهای کار جاری
+        int job = -1;               // -1: بیکار
+        chrono::steady_clock::time_point started;
+    };
     
-    // تابع ارزیابی اصلی
-    double evaluate(const CheckersGame& game) {
-        if (game.isGameOver()) {
-            PieceType winner = game.getWinner();
-            if (winner == player) {
-                return 1000.0;
-            } else if (winner == PieceType::EMPTY) {
-                return 0.0;} else {
-                return -1000.0;
-            }
+    WorkerPoolOptions options;
+    WorkerFactory factory;
+    vector<Worker> workers;
+    deque<int> queue;
+    vector<int> attempts;
+    WorkerPoolStats stats;
+    
+    static bool writeAll(int fd, const string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
         }
-        
-        return eval_functions[eval_func](game, player);
+        return true;
     }
     
-    // تابع ارزیابی پایه
-    double evaluateBasic(const CheckersGame& game, PieceType player) {
-        double score = 0.0;
-        auto board = game.getBoard();
-        
-        for (int i = 0; i < 6; i++) {
-            for (int j = 0; j < 6; j++) {PieceType piece = board[i][j];
-                
-                if (piece == PieceType::EMPTY || !game.isBlackSquare({i, j})) {
+    // هر چه آماده است به buffer اضافه می‌شود؛ false در EOF یا خطا
+    static bool readAvailable(int fd, string& buffer) {
+        char chunk[4096];
+        ssize_t n;
+        do {
+            n = read(fd, chunk, sizeof(chunk));
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+    
+    static bool nextLine(string& buffer, string& line) {
+        size_t end = buffer.find('\n');
+        if (end == string::npos) return false;
+        line = buffer.substr(0, end);
+        buffer.erase(0, end + 1);
+        return true;
+    }
+    
+    // بدنه پردازه کارگر؛ هرگز برنمی‌گردد
+    [[noreturn]] void workerMain(int fd, int id) {
+#ifdef __linux__
+        if (options.pin) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(id % max(1u, thread::hardware_concurrency()), &cpus);
+            sched_setaffinity(0, sizeof(cpus), &cpus);
+        }
+#endif
+        {
+            WorkerHandler handler = factory(id);
+            string buffer, line;
+            while (true) {
+                if (!nextLine(buffer, line)) {
+                    if (!readAvailable(fd, buffer)) break;
                     continue;
                 }
+                if (line == "quit") break;
+                size_t space = line.find(' ');
+                int job = stoi(line.substr(0, space));
+                string payload = space == string::npos ? "" : line.substr(space + 1);
                 
-                double piece_value = 0.0;
-                
-                if (piece == player) {
-                    piece_value = 1.0; // مهره معمولی خودی
-                } else if ((player == PieceType::BLACK_PIECE && piece == PieceType::BLACK_KING) ||(player == PieceType::WHITE_PIECE && piece == PieceType::WHITE_KING)) {
-                    piece_value = 3.0; // شاه خودی
-                } else if (piece == PieceType::BLACK_PIECE || piece == PieceType::WHITE_PIECE) {
-                    piece_value = -1.0; // مهره معمولی حریف
-                } else {
-                    piece_value = -3.0; // شاه حریف
+                string reply;
+                for (const string& out : handler(job, payload)) {
+                    reply += out + "\n";
                 }
-                
-                score += piece_value;
+                reply += "done " + to_string(job) + "\n";
+                if (!writeAll(fd, reply)) break;
             }
         }
-        
-        return score;
+        close(fd);
+        cout.flush();
+        cerr.flush();
+        _exit(0);
     }
-    // تابع ارزیابی پیشرفته
-    double evaluateAdvanced(const CheckersGame& game, PieceType player) {
-        double score = evaluateBasic(game, player);
-        auto board = game.getBoard();
-        
-        // ماتریس ارزش موقعیت
-        vector<vector<double>> positional_value = {
-            {0, 0, 0, 0, 0, 0},
-            {0, 0.1, 0, 0.1, 0, 0.1},
-            {0.1, 0, 0.2, 0, 0.2, 0},
-            {0, 0.2, 0, 0.2, 0, 0.1},
-            {0.1, 0, 0.2, 0, 0.1, 0},
-            {0, 0.1, 0, 0.1, 0, 0}
-        };
-        for (int i = 0; i < 6; i++) {
-            for (int j = 0; j < 6; j++) {
-                if (!game.isBlackSquare({i, j})) continue;
-                
-                PieceType piece = board[i][j];
-                PieceType piece_color = game.getPieceColor(piece);
-                
-                if (piece_color == player) {
-                    // امتیاز موقعیت برای مهره‌های خودی
-                    score += positional_value[i][j];
-                       // امتیاز برای نزدیکی به تبدیل شدن به شاه
-                    if (!game.isKing(piece)) {
-                        if (player == PieceType::BLACK_PIECE) {
-                            score += i * 0.05; // سیاه: هر چه پایین‌تر بهتر
-                        } else {
-                            score += (5 - i) * 0.05; // سفید: هر چه بالاتر بهتر
-                        }
-                    }
-                } else if (piece_color != PieceType::EMPTY) {
-                    // کسر امتیاز برای مهره‌های حریف
-                    score -= positional_value[i][j];
-                }
+    
+    bool spawn(Worker& worker) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            return false;
+        }
+        cout.flush();
+        cerr.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            for (const Worker& other : workers) {
+                if (other.fd >= 0) close(other.fd);
+            }
+            workerMain(fds[1], worker.id);
+        }
+        close(fds[1]);
+        worker.pid = pid;
+        worker.fd = fds[0];
+        worker.buffer.clear();
+        worker.lines.clear();
+        worker.job = -1;
+        return true;
+    }
+    
+    // کارگر مرده: برداشت پردازه، بازگرداندن کار به صف و جایگزینی
+    void handleFailure(Worker& worker) {
+        close(worker.fd);
+        worker.fd = -1;
+        int status = 0;
+        waitpid(worker.pid, &status, 0);
+        cerr << "worker " << worker.id << " (pid " << worker.pid << ") "
+             << (WIFSIGNALED(status) ? "killed by signal " + to_string(WTERMSIG(status))
+                                     : "exited with status " + to_string(WEXITSTATUS(status)));
+        if (worker.job >= 0) {
+            cerr << " during job " << worker.job;
+            if (++attempts[worker.job] < options.max_attempts) {
+                queue.push_front(worker.job);
+            } else {
+                cerr << " (given up after " << attempts[worker.job] << " attempts)";
+                stats.failed++;
             }
+            worker.job = -1;
         }
-        
-        return score;
+        if (stats.restarts < options.max_restarts && spawn(worker)) {
+            stats.restarts++;
+            cerr << ", restarted as pid " << worker.pid;
+        }
+        cerr << endl;
     }
     
-    // تابع ارزیابی موقعیتی
-    double evaluatePositional(const CheckersGame& game, PieceType player) {
-        double score = evaluateBasic(game, player);
-        
-        // اهمیت مهره‌های دفاعی و تهاجمی
-        auto board = game.getBoard();
+public:
+    WorkerPool(const WorkerPoolOptions& pool_options, WorkerFactory worker_factory)
+        : options(pool_options), factory(move(worker_factory)) {
+        options.workers = max(1, options.workers);
+    }
+    
+    // کار i با payloads[i]؛ on_result(i, سطرها) به ترتیب پایان کارها و در همین نخ صدا زده می‌شود.
+    // کارهایی که کنار گذاشته شوند در stats.failed شمرده می‌شوند و نتیجه‌ای ندارند.
+    WorkerPoolStats run(const vector<string>& payloads,
+                        const function<void(int, const vector<string>&)>& on_result) {
+        // نوشتن روی socket کارگر مرده باید خطا بدهد، نه اینکه هماهنگ‌کننده را بکشد؛
+        // handler قبلی در پایان run برگردانده می‌شود
+        auto previous_sigpipe = signal(SIGPIPE, SIG_IGN);
+        stats = WorkerPoolStats();
+        const int total = static_cast<int>(payloads.size());
+        queue.clear();
+        for (int job = 0; job < total; job++) {
+            queue.push_back(job);
+        }
+        attempts.assign(total, 0);
+        workers.assign(options.workers, Worker());
+        for (int i = 0; i < options.workers; i++) {
+            workers[i].id = i;
+            if (!spawn(workers[i])) {
+                cerr << "cannot start worker " << i << ": " << strerror(errno) << endl;
+            }
+        }
         
-        for (int i = 0; i < 6; i++) {
-            for (int j = 0; j < 6; j++) {
-                if (!game.isBlackSquare({i, j})) continue;
-                
-                PieceType piece = board[i][j];
-                PieceType piece_color = game.getPieceColor(piece);
-                
-                if (piece_color == player) {
-                    // مهره‌های در خانه‌های امن (مرکزی) ارزش بیشتری دارند
-                    if (j >= 1 && j <= 4) {
-                        score += 0.1;
+        while (stats.completed + stats.failed < total) {
+            for (Worker& worker : workers) {
+                if (worker.fd < 0 || worker.job >= 0 || queue.empty()) continue;
+                worker.job = queue.front();
+                queue.pop_front();
+                worker.started = chrono::steady_clock::now();
+                if (!writeAll(worker.fd, to_string(worker.job) + " " + payloads[worker.job] + "\n")) {
+                    handleFailure(worker);
+                }
+            }
+            
+            vector<pollfd> fds;
+            vector<Worker*> owners;
+            for (Worker& worker : workers) {
+                if (worker.fd >= 0) {
+                    fds.push_back({worker.fd, POLLIN, 0});
+                    owners.push_back(&worker);
+                }
+            }
+            if (fds.empty()) {
+                cerr << "no workers left; " << queue.size() << " jobs not run" << endl;
+                stats.failed += static_cast<int>(queue.size());
+                queue.clear();
+                break;
+            }
+            if (poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+                cerr << "poll: " << strerror(errno) << endl;
+                break;
+            }
+            
+            for (size_t i = 0; i < fds.size(); i++) {
+                Worker& worker = *owners[i];
+                if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+                if (!readAvailable(worker.fd, worker.buffer)) {
+                    handleFailure(worker);
+                    continue;
+                }
+                string line;
+                while (nextLine(worker.buffer, line)) {
+                    if (line.compare(0, 5, "done ") == 0 && worker.job >= 0) {
+                        on_result(worker.job, worker.lines);
+                        worker.lines.clear();
+                        worker.job = -1;
+                        stats.completed++;
+                    } else {
+                        worker.lines.push_back(line);
                     }
-                    
-                    // مهره‌های نزدیک به دیوار آسیب‌پذیر هستند
-                    if (j == 0 || j == 5) {
-                        score -= 0.05;
+                }
+            }
+            
+            if (options.job_timeout_s > 0) {
+                auto now = chrono::steady_clock::now();
+                for (Worker& worker : workers) {
+                    if (worker.fd >= 0 && worker.job >= 0 &&
+                        chrono::duration<double>(now - worker.started).count() > options.job_timeout_s) {
+                        kill(worker.pid, SIGKILL);
+                        stats.timeouts++;
+                        handleFailure(worker);
                     }
                 }
             }
         }
         
-        return score;
+        for (Worker& worker : workers) {
+            if (worker.fd >= 0) {
+                writeAll(worker.fd, "quit\n");
+                close(worker.fd);
+                worker.fd = -1;
+                waitpid(worker.pid, nullptr, 0);
+            }
+        }
+        signal(SIGPIPE, previous_sigpipe);
+        return stats;
     }
-    
-    int getNodesExpanded() const { return nodes_expanded; }
 };
 
+string workerPoolSummary(const WorkerPoolOptions& options, const WorkerPoolStats& stats) {
+    ostringstream out;
+    out << "workers: " << options.workers << (options.pin ? " (pinned)" : "")
+        << ", restarts: " << stats.restarts << ", timeouts: " << stats.timeouts
+        << ", failed jobs: " << stats.failed;
+    return out.str();
+}
+
+// تورنمنت runExperiments روی کارگرها. بذر هر بازی از شماره آن مشتق می‌شود، پس برای
+// عامل‌های بدون حالت ماندگار نتیجه‌ها همان اجرای تک‌پردازه‌ای با همان --seed است و فقط
+// زمان‌ها فرق می‌کنند. عامل learning استثناست: هر کارگر فقط تجربه بازی‌های قبلی خودش را
+// در فایل تجربه خودش می‌بیند، نه تجربه همه بازی‌های 1..N-1.
+void runDistributedExperiments(GameManager& manager, const WorkerPoolOptions& options, int num_games,
+                               const string& agent1_type, const string& agent2_type, int depth,
+                               bool use_alpha_beta, bool log_search) {
+    const uint64_t seed = manager.getMasterSeed();
+    WorkerPool pool(options, [=](int worker_id) -> WorkerHandler {
+        auto worker_manager = make_shared<GameManager>();
+        worker_manager->setMasterSeed(seed);
+        // هر کارگر فایل تجربه خودش را دارد؛ نوشتن هم‌زمان روی یک فایل تجربه‌ها را گم می‌کرد
+        worker_manager->setExperienceFile("checkers_experience.w" + to_string(worker_id) + ".dat");
+        worker_manager->setResultsOutput("");
+        worker_manager->setSearchLogging(log_search);
+        worker_manager->beginExperiments(agent1_type, agent2_type);
+        return [=](int, const string& payload) {
+            ExperimentGame row = worker_manager->playExperimentGame(stoi(payload), agent1_type, agent2_type,
+                                                                    depth, use_alpha_beta);
+            vector<string> lines;
+            for (const MoveRecord& record : worker_manager->takeMoveRecords()) {
+                lines.push_back("move " + to_string(record.ply) + " " + to_string(record.side) + " " +
+                                to_string(record.latency_us) + " " + to_string(record.nodes));
+            }
+            lines.push_back("game " + to_string(row.winner) + " " + to_string(row.moves) + " " +
+                            to_string(row.black_nodes) + " " + to_string(row.white_nodes));
+            return lines;
+        };
+    });
+    
+    cout << num_games << " game between " << agent1_type << " black and" << agent2_type << " (white)"
+         << " on " << options.workers << " worker processes" << endl;
+    cout << "depth search: " << depth << ", Alpha-Beta: " << (use_alpha_beta ? "active" : "inactive")
+         << ", seed: " << seed << endl;
+    
+    vector<string> payloads;
+    for (int game_num = 1; game_num <= num_games; game_num++) {
+        payloads.push_back(to_string(game_num));
+    }
+    vector<ExperimentGame> games(num_games);
+    vector<vector<MoveRecord>> records(num_games);
+    vector<bool> finished(num_games, false);
+    auto start = chrono::steady_clock::now();
+    WorkerPoolStats stats = pool.run(payloads, [&](int job, const vector<string>& lines) {
+        for (const string& line : lines) {
+            istringstream in(line);
+            string kind;
+            in >> kind;
+            if (kind == "move") {
+                MoveRecord record;
+                record.game = job + 1;
+                in >> record.ply >> record.side >> record.latency_us >> record.nodes;
+                records[job].push_back(record);
+            } else if (kind == "game") {
+                games[job].game = job + 1;
+                in >> games[job].winner >> games[job].moves >> games[job].black_nodes >> games[job].white_nodes;
+            }
+        }
+        finished[job] = true;
+        cout << "\n number game" << job + 1 << ":" << endl;
+        GameManager::printGameResult(games[job], agent1_type, agent2_type);
+    });
+    double elapsed_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    // آمار به ترتیب شماره بازی، مستقل از ترتیب پایان کارها
+    manager.beginExperiments(agent1_type, agent2_type);
+    vector<ExperimentGame> completed;
+    for (int g = 0; g < num_games; g++) {
+        if (!finished[g]) continue;
+        completed.push_back(games[g]);
+        for (const MoveRecord& record : records[g]) {
+            manager.recordMove(record);
+        }
+    }
+    cout << "\n" << workerPoolSummary(options, stats) << endl;
+    manager.reportExperiments(completed, agent1_type, agent2_type, depth, use_alpha_beta, elapsed_s,
+                              ", \"workers\": " + to_string(options.workers) +
+                              ", \"worker_restarts\": " + to_string(stats.restarts) +
+                              ", \"failed_games\": " + to_string(stats.failed));
+}
+
+// تحلیل موقعیت‌ها روی کارگرها؛ همان سطرهای JSON حالت analyze، به ترتیب ورودی
+void runDistributedAnalysis(const vector<uint64_t>& positions, const WorkerPoolOptions& options,
+                            int depth, int multipv, const string& eval_name, int movetime_ms,
+                            ostream& out, ostream& summary) {
+    WorkerPool pool(options, [=](int) -> WorkerHandler {
+        auto agent = make_shared<MinimaxAgent>(PieceType::BLACK_PIECE, depth, true, eval_name);
+        SearchLimits limits;
+        limits.depth = depth;
+        limits.movetime_ms = movetime_ms;
+        return [=](int job, const string& payload) {
+            BatchAnalysisItem item;
+            item.index = static_cast<size_t>(job);
+            item.position = stoull(payload);
+            CheckersGame game;
+            auto start = chrono::steady_clock::now();
+            if (game.unpack(item.position) && !game.isGameOver()) {
+                agent->clearTranspositionTable();
+                item.result = agent->analyze(game, multipv, limits);
+            }
+            long long latency_us = chrono::duration_cast<chrono::microseconds>(
+                chrono::steady_clock::now() - start).count();
+            return vector<string>{"analysis " + to_string(item.result.nodes) + " " + to_string(latency_us) +
+                                  " " + analysisToJson(item)};
+        };
+    });
+    
+    vector<string> payloads;
+    for (uint64_t packed : positions) {
+        payloads.push_back(to_string(packed));
+    }
+    // نتیجه‌های زودرس تا رسیدن نوبتشان نگه داشته می‌شوند
+    map<int, string> pending;
+    int next_emit = 0;
+    LatencyHistogram latency;
+    long long total_nodes = 0;
+    auto start = chrono::steady_clock::now();
+    WorkerPoolStats stats = pool.run(payloads, [&](int job, const vector<string>& lines) {
+        for (const string& line : lines) {
+            istringstream in(line);
+            string kind;
+            long long nodes = 0, latency_us = 0;
+            in >> kind >> nodes >> latency_us;
+            if (kind != "analysis") continue;
+            string json;
+            getline(in >> ws, json);
+            pending[job] = json;
+            latency.record(latency_us);
+            total_nodes += nodes;
+        }
+        while (!pending.empty() && pending.begin()->first == next_emit) {
+            out << pending.begin()->second << "\n";
+            pending.erase(pending.begin());
+            next_emit++;
+        }
+    });
+    // پس از کار کنار گذاشته‌شده، بقیه به ترتیب
+    for (const auto& entry : pending) {
+        out << entry.second << "\n";
+    }
+    out.flush();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    summary << "analyzed " << stats.completed << " positions in " << seconds << "s ("
+            << static_cast<long long>(stats.completed / max(seconds, 1e-9)) << " positions/s, "
+            << static_cast<long long>(total_nodes / max(seconds, 1e-9)) << " nodes/s), latency p50="
+            << latency.percentile(50) << "us p95=" << latency.percentile(95) << "us p99="
+            << latency.percentile(99) << "us max=" << latency.maximum() << "us" << endl;
+    summary << workerPoolSummary(options, stats) << endl;
+}
+
+#endif
+
 // ============================================================================
-// عامل یادگیرنده
+// پروتکل متنی موتور روی stdin/stdout (مشابه UCI)
 // ============================================================================
 
-class LearningAgent : public MinimaxAgent {
+// دستورها:
+//   checkers | isready | newgame | d | stop | quit
+//   setoption name Eval|Depth value V
+//   position startpos|key <36 رقم> <b|w>|fen <FEN> [moves m1 m2 ...]   (حرکت: moveToString)
+//   go [depth N] [movetime MS] [nodes N] [infinite]
+// پاسخ‌ها: info depth .. score .. nodes .. nps .. time .. pv ..، bestmove <move|none>
+class EngineProtocol {
 private:
-    double learning_rate;
-    unordered_map<string, pair<double, Move>> experience;
-    string experience_file = "checkers_experience.dat";
+    static constexpr int MAX_DEPTH = 64;
     
-public:
-    LearningAgent(PieceType p, int d = 3, bool ab = true, 
-                 string ef = "basic", double lr = 0.1)
-        : MinimaxAgent(p, d, ab, ef), learning_rate(lr) {
-        name = "Learning Agent (d=" + to_string(depth) + ")";
-        loadExperience();
+    istream& in;
+    ostream& out;
+    mutex out_mutex;
+    
+    CheckersGame game;
+    string eval_name = "advanced";
+    int default_depth = 6;
+    SearchOptions search_options;
+    
+    // یک موتور برای هر رنگ؛ بین جستجوها گرم می‌ماند
+    array<unique_ptr<MinimaxAgent>, 2> engines;
+    thread search_thread;
+    atomic<bool> stop_flag{false};
+    
+    void send(const string& line) {
+        lock_guard<mutex> lock(out_mutex);
+        out << line << endl;
     }
     
-    ~LearningAgent() {
-        saveExperience();
+    MinimaxAgent& engineFor(PieceType side) {
+        int index = (side == PieceType::BLACK_PIECE) ? 0 : 1;
+        if (!engines[index]) {
+            engines[index] = make_unique<MinimaxAgent>(side, default_depth, true, eval_name);
+            engines[index]->setSearchOptions(search_options);
+        }
+        return *engines[index];
     }
     
-    Move getMove(const CheckersGame& game) override {
-        nodes_expanded = 0;
-        vector<Move> moves = game.getAllValidMoves(player);
-        
-        if (moves.empty()) {
-            return Move();
+    void stopSearch() {
+        stop_flag = true;
+        if (search_thread.joinable()) {
+            search_thread.join();
         }
-        
-        // بررسی تجربیات گذشته
-        string board_key = game.getBoardKey();
-        auto it = experience.find(board_key);
-        if (it != experience.end()) {
-            const Move& stored_move = it->second.second;
-            
-            // بررسی معتبر بودن حرکت ذخیره شده
-            for (const auto& move : moves) {
-                if (movesEqual(move, stored_move)) {
-                    return move;
-                }
+        stop_flag = false;
+    }
+    
+    static string scoreText(double score) {
+        if (score >= 1000.0) return "win";
+        if (score <= -1000.0) return "loss";
+        return "cp " + to_string(static_cast<long long>(llround(score * 100.0)));
+    }
+    
+    // اعمال حرکت متنی در صورت قانونی بودن
+    static bool applyMoveText(CheckersGame& target, const string& text) {
+        for (const auto& move : target.getAllValidMoves(target.getCurrentPlayer())) {
+            if (moveToString(move) == text) {
+                target.applyMove(move);
+                return true;
             }
         }
-        
-        // استفاده از Minimax
-        return MinimaxAgent::getMove(game);
+        return false;
     }
     
-    // یادگیری از بازی
-    void learnFromGame(const vector<Move>& game_history, double result) {
-        // result: 1.0 برای برد، 0.0 برای مساوی، -1.0 برای باخت
+    void handlePosition(istringstream& tokens) {
+        string kind;
+        tokens >> kind;
+        CheckersGame next;
+        if (kind == "key") {
+            string key, side;
+            tokens >> key >> side;
+            PieceType to_move = (side == "w") ? PieceType::WHITE_PIECE : PieceType::BLACK_PIECE;
+            if ((side != "b" && side != "w") || !next.setFromBoardKey(key, to_move)) {
+                send("info string error invalid position");
+                return;
+            }
+        } else if (kind == "fen") {
+            string fen;
+            tokens >> fen;
+            if (!next.setFromFen(fen)) {
+                send("info string error invalid fen");
+                return;
+            }
+        } else if (kind != "startpos") {
+            send("info string error unknown position type " + kind);
+            return;
+        }
         
-        for (size_t i = 0; i < game_history.size(); i++) {
-            double move_value = result * (1.0 - static_cast<double>(i) / game_history.size());
-            
-            const Move& move = game_history[i];
-            if (!move.board_before.empty()) {
-                string key = move.board_before;
-                auto it = experience.find(key);
-                
-                if (it != experience.end()) {
-                    // به‌روزرسانی تجربه موجود
-                    double old_value = it->second.first;
-                    double new_value = old_value + learning_rate * (move_value - old_value);
-                    it->second = make_pair(new_value, move);
-                } else {
-                    // افزودن تجربه جدید
-                    experience[key] = make_pair(move_value, move);
+        // موقعیت فقط وقتی جایگزین می‌شود که همه حرکت‌ها قانونی باشند
+        string word;
+        if (tokens >> word && word == "moves") {
+            while (tokens >> word) {
+                if (!applyMoveText(next, word)) {
+                    send("info string error illegal move " + word);
+                    return;
                 }
             }
         }
-        
-        saveExperience();
+        game = next;
     }
     
-    // مقایسه دو حرکت
-    bool movesEqual(const Move& m1, const Move& m2) const {
-        if (m1.from != m2.from) return false;
-        if (m1.to.empty() || m2.to.empty()) return false;
-        return m1.to.back() == m2.to.back();
+    void handleGo(istringstream& tokens) {
+        SearchLimits limits;
+        string word;
+        while (tokens >> word) {
+            if (word == "depth") {
+                tokens >> limits.depth;
+            } else if (word == "movetime") {
+                tokens >> limits.movetime_ms;
+            } else if (word == "nodes") {
+                tokens >> limits.nodes;
+            } else if (word == "infinite") {
+                limits.depth = MAX_DEPTH;
+            }
+        }
+        // با محدودیت زمان یا گره، عمق تا سقف ادامه می‌یابد
+        if (limits.depth <= 0) {
+            limits.depth = (limits.movetime_ms > 0 || limits.nodes > 0) ? MAX_DEPTH : default_depth;
+        }
+        limits.depth = min(limits.depth, MAX_DEPTH);
+        limits.stop = &stop_flag;
+        
+        CheckersGame position = game.copy();
+        MinimaxAgent& engine = engineFor(position.getCurrentPlayer());
+        search_thread = thread([this, position, limits, &engine]() {
+            Move best = engine.searchIterative(position, limits, [this](const SearchInfo& info) {
+                ostringstream line;
+                line << "info depth " << info.depth << " score " << scoreText(info.score)
+                     << " nodes " << info.nodes << " nps "
+                     << static_cast<long long>(info.elapsed_ms > 0 ? info.nodes * 1000.0 / info.elapsed_ms : 0)
+                     << " time " << static_cast<long long>(info.elapsed_ms) << " pv";
+                for (const auto& move : info.pv) {
+                    line << " " << moveToString(move);
+                }
+                send(line.str());
+            });
+            send("bestmove " + (best.to.empty() ? string("none") : moveToString(best)));
+        });
     }
     
-    // ذخیره تجربیات
-    void saveExperience() {
-        ofstream file(experience_file, ios::binary);
-        if (file.is_open()) {
-            size_t size = experience.size();
-            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-            
-            for (const auto& entry : experience) {
-                // ذخیره کلید
-                size_t key_size = entry.first.size();
-                file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
-                file.write(entry.first.c_str(), key_size);
-                
-                // ذخیره مقدار
-                file.write(reinterpret_cast<const char*>(&entry.second.first), sizeof(double));
-                
-                // ذخیره حرکت (ساده شده)
-                const Move& m = entry.second.second;
-                file.write(reinterpret_cast<const char*>(&m.from.row), sizeof(int));
-                file.write(reinterpret_cast<const char*>(&m.from.col), sizeof(int));
-                Position to_pos = m.to.empty() ? Position() : m.to.back();
-                file.write(reinterpret_cast<const char*>(&to_pos.row), sizeof(int));
-                file.write(reinterpret_cast<const char*>(&to_pos.col), sizeof(int));
+    void handleSetOption(istringstream& tokens) {
+        string word, option, value;
+        tokens >> word >> option >> word >> value;
+        // مقدار نامعتبر رد می‌شود و تنظیم جاری دست نمی‌خورد
+        if (option == "Eval") {
+            if (!engineFor(PieceType::BLACK_PIECE).hasEvaluator(value)) {
+                send("info string error unknown Eval " + value);
+                return;
             }
-            file.close();
+            eval_name = value;
+        } else if (option == "Depth") {
+            char* end = nullptr;
+            errno = 0;
+            long depth = strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || errno != 0 || depth < 1 || depth > MAX_DEPTH) {
+                send("info string error invalid Depth " + value);
+                return;
+            }
+            default_depth = static_cast<int>(depth);
+        } else if (option == "LMR") {
+            search_options.lmr = (value == "true");
+        } else if (option == "Futility") {
+            search_options.futility = (value == "true");
+        } else if (option == "ProbCut") {
+            search_options.probcut = (value == "true");
+        } else {
+            send("info string error unknown option " + option);
+            return;
         }
+        engines[0].reset();
+        engines[1].reset();
     }
     
-    // بارگذاری تجربیات
-    void loadExperience() {
-        ifstream file(experience_file, ios::binary);
-        if (file.is_open()) {
-            size_t size;
-            file.read(reinterpret_cast<char*>(&size), sizeof(size));
+public:
+    EngineProtocol(istream& input = cin, ostream& output = cout) : in(input), out(output) {}
+    
+    ~EngineProtocol() {
+        stopSearch();
+    }
+    
+    int run() {
+        string line;
+        while (getline(in, line)) {
+            istringstream tokens(line);
+            string command;
+            if (!(tokens >> command)) {
+                continue;
+            }
             
-            for (size_t i = 0; i < size; i++) {
-                // خواندن کلید
-                size_t key_size;
-                file.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
-                string key(key_size, ' ');
-                file.read(&key[0], key_size);
-                
-                // خواندن مقدار
-                double value;
-                file.read(reinterpret_cast<char*>(&value), sizeof(double));
-                
-                // خواندن حرکت
-                Move m;
-                file.read(reinterpret_cast<char*>(&m.from.row), sizeof(int));
-                file.read(reinterpret_cast<char*>(&m.from.col), sizeof(int));
-                Position to_pos;
-                file.read(reinterpret_cast<char*>(&to_pos.row), sizeof(int));
-                file.read(reinterpret_cast<char*>(&to_pos.col), sizeof(int));
-                m.to.push_back(to_pos);
-                
-                experience[key] = make_pair(value, m);
+            if (command == "checkers") {
+                send("id name lastprojAI checkers");
+                send("option name Eval type combo default " + eval_name +
+                     " var basic var advanced var positional var learned var nnue");
+                send("option name Depth type spin default " + to_string(default_depth) +
+                     " min 1 max " + to_string(MAX_DEPTH));
+                send("option name LMR type check default false");
+                send("option name Futility type check default false");
+                send("option name ProbCut type check default false");
+                send("checkersok");
+            } else if (command == "isready") {
+                send("readyok");
+            } else if (command == "newgame") {
+                stopSearch();
+                game = CheckersGame();
+            } else if (command == "setoption") {
+                stopSearch();
+                handleSetOption(tokens);
+            } else if (command == "position") {
+                stopSearch();
+                handlePosition(tokens);
+            } else if (command == "go") {
+                stopSearch();
+                handleGo(tokens);
+            } else if (command == "stop") {
+                stopSearch();
+            } else if (command == "d") {
+                send(string("key ") + game.getBoardKey() + " " +
+                     (game.getCurrentPlayer() == PieceType::BLACK_PIECE ? "b" : "w"));
+                send("fen " + game.toFen());
+            } else if (command == "quit") {
+                break;
+            } else {
+                send("info string error unknown command " + command);
             }
-            file.close();
         }
+        stopSearch();
+        return 0;
     }
 };
 
 // ============================================================================
-// کلاس مدیریت بازی
+// حالت‌های خط فرمان
 // ============================================================================
 
-class GameManager {
-private:
-    CheckersGame game;
-    unique_ptr<CheckersAgent> agent1; // سیاه
-    unique_ptr<CheckersAgent> agent2; // سفید
-    string game_mode;
-    
-public:
-    GameManager() : game() {}
-    
-    // تنظیم بازی
-    void setupGame(const string& mode = "human_vs_agent", 
-                   const string& agent1_type = "minimax",
-                   const string& agent2_type = "random",
-                   int depth = 3, bool use_alpha_beta = true) {
-        game_mode = mode;
+// خواندن گزینه --name value از آرگومان‌ها
+string getOption(const vector<string>& args, const string& name, const string& default_value) {
+    for (size_t i = 0; i + 1 < args.size(); i++) {
+        if (args[i] == name) {
+            return args[i + 1];
+        }
+    }
+    return default_value;
+}
+
+int runCommandLine(const vector<string>& args) {
+    const string& mode = args[0];
+
+    // جدول موقعیت‌های حل‌شده برای عامل‌های minimax در همه حالت‌ها
+    string solved_file = getOption(args, "--solved", "");
+    if (!solved_file.empty()) {
+        solvedTableFile() = solved_file;
+    }
+
+    if (mode == "protocol") {
+        // موتور ماندگار برای ابزارهای بیرونی (GUI، مسابقه)
+        EngineProtocol protocol;
+        return protocol.run();
+    }
+
+    if (mode == "train-td") {
+        // آموزش ارزیاب خطی با TD(λ)
+        LinearEvaluator evaluator;
+        string weights_file = getOption(args, "--weights", "checkers_weights.dat");
+        if (getOption(args, "--resume", "no") == "yes") {
+            evaluator.loadWeights(weights_file);
+        }
+        // با 0 بازی به‌روزرسانی دسته تقسیم بر صفر است و وزن‌های NaN روی فایل نوشته می‌شوند
+        int batches = stoi(getOption(args, "--batches", "50"));
+        int games = stoi(getOption(args, "--games", "64"));
+        if (batches < 1 || games < 1) {
+            cout << "--batches and --games must be at least 1" << endl;
+            return 1;
+        }
+
+        TDLambdaTrainer trainer(evaluator,
+                                stod(getOption(args, "--alpha", "0.01")),
+                                stod(getOption(args, "--lambda", "0.7")),
+                                stod(getOption(args, "--epsilon", "0.1")),
+                                stoi(getOption(args, "--threads", "0")),
+                                stoull(getOption(args, "--seed", "1")));
+        trainer.train(batches, games, weights_file);
+        return 0;
+    }
+
+    if (mode == "perft") {
+        // شمارش گره‌ها برای موقعیت شروع یا مجموعه موقعیت‌های ذخیره شده
+        int depth = stoi(getOption(args, "--depth", "6"));
+        string which = getOption(args, "--position", "start");
+        bool divide = getOption(args, "--divide", "no") == "yes";
+        string variant = getOption(args, "--variant", "6x6");
+        PerftRunner runner(stoi(getOption(args, "--threads", "1")),
+                           getOption(args, "--bulk", "yes") == "yes");
         
-        if (mode == "human_vs_agent") {
-            agent1 = nullptr; // انسان
-            agent2 = createAgent(agent2_type, PieceType::WHITE_PIECE, depth, use_alpha_beta);
-        } else if (mode == "human_vs_human") {
-            agent1 = nullptr;
-            agent2 = nullptr;
+        if (variant == Rules6x6::NAME) {
+            return runner.runPositions<CheckersGame>(PERFT_POSITIONS, which, depth, divide);
+        } else if (variant == RulesEnglish8x8::NAME) {
+            return runner.runPositions<EnglishCheckersGame>(PERFT_POSITIONS_ENGLISH, which, depth, divide);
+        } else if (variant == RulesFlying8x8::NAME) {
+            return runner.runPositions<FlyingCheckersGame>(PERFT_POSITIONS_FLYING, which, depth, divide);
         }
+        cout << "unknown variant: " << variant << endl;
+        return 1;
     }
     
-    // ایجاد عامل
-    unique_ptr<CheckersAgent> createAgent(const string& type, PieceType player, 
-                                         int depth, bool use_alpha_beta) {
-        if (type == "random") {
-            return make_unique<RandomAgent>(player);
-        } else if (type == "greedy") {
-            return make_unique<GreedyAgent>(player);
-        } else if (type == "minimax") 
-        {
-            return make_unique<MinimaxAgent>(player, depth, use_alpha_beta, "advanced");
-        } else if (type == "learning") {
-            return make_unique<LearningAgent>(player, depth, use_alpha_beta, "advanced", 0.1);
+    if (mode == "selfplay") {
+        string input = getOption(args, "--in", "");
+        if (!input.empty()) {
+            // خلاصه یک فایل داده
+            size_t count = 0, wins = 0, draws = 0, losses = 0;
+            long long score_sum = 0;
+            size_t records = readSelfPlayDataset(input, [&](const SelfPlayRecord& record) {
+                count++;
+                wins += record.result > 0;
+                draws += record.result == 0;
+                losses += record.result < 0;
+                score_sum += record.score;
+            });
+            if (records == 0) {
+                cout << "no self-play records in " << input << endl;
+                return 1;
+            }
+            cout << "records: " << count << " (side to move won " << wins << ", drew " << draws
+                 << ", lost " << losses << "), mean score: "
+                 << static_cast<double>(score_sum) / count << " centi-men" << endl;
+            return 0;
         }
-        return make_unique<RandomAgent>(player); // پیش‌فرض
+        
+        string output = getOption(args, "--out", "selfplay.ckd");
+        DatasetWriter writer(output);
+        if (!writer.isOpen()) {
+            cout << "cannot write " << output << endl;
+            return 1;
+        }
+        SelfPlayGenerator generator(stoi(getOption(args, "--games", "100")),
+                                    stoi(getOption(args, "--threads", "0")),
+                                    stoi(getOption(args, "--depth", "4")),
+                                    getOption(args, "--eval", "advanced"),
+                                    stoi(getOption(args, "--random-plies", "4")),
+                                    stod(getOption(args, "--epsilon", "0.05")),
+                                    min(255, stoi(getOption(args, "--max-plies", "200"))),
+                                    stoull(getOption(args, "--seed", "1")));
+        generator.run(writer);
+        cout << "wrote " << writer.recordsWritten() << " records to " << output << endl;
+        return 0;
     }
     
-    // اجرای یک بازی کامل
-    void playGame(bool display = true) {
-        game = CheckersGame();
-        vector<Move> game_history;
-        
-        if (display) {
-            cout << "start checker << endl;
-            game.printBoard();
+    if (mode == "tune") {
+        // برازش Texel ضرایب ارزیاب روی نتایج بازی‌های یک فایل selfplay
+        string input = getOption(args, "--in", "selfplay.ckd");
+        string eval_name = getOption(args, "--eval", "advanced");
+        size_t max_positions = stoull(getOption(args, "--max-positions", "0"));
+        TexelTuner tuner(stoi(getOption(args, "--threads", "0")), eval_name);
+        CheckersGame game;
+        readSelfPlayDataset(input, [&](const SelfPlayRecord& record) {
+            if ((max_positions == 0 || tuner.size() < max_positions) && game.unpack(record.position)) {
+                tuner.addPosition(game, record.result);
+            }
+        });
+        if (tuner.size() == 0) {
+            cout << "no self-play records in " << input << endl;
+            return 1;
         }
         
-        while (!game.isGameOver()) {
-            string player_name = (game.getCurrentPlayer() == PieceType::BLACK_PIECE) ? 
-                               "black" :"white";
-            
-            if (display) {
-                cout << "\n player " << player_name << endl;
+        EvalParams params = evalParams();
+        auto start = chrono::steady_clock::now();
+        double k = tuner.fitScale(params);
+        cout << "positions: " << tuner.size() << ", parameters: " << tuner.activeParams().size()
+             << ", threads: " << tuner.getThreads() << ", K: " << k
+             << ", initial error: " << tuner.error(params, k) << endl;
+        params = tuner.tune(params, k, stoi(getOption(args, "--iterations", "200")),
+                            stod(getOption(args, "--lr", "0.01")),
+                            [](int iter, double error) {
+                                cout << "iteration " << iter << ": error " << error << endl;
+                            });
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        for (int index : tuner.activeParams()) {
+            cout << "  " << EvalParams::name(index) << " = " << params.values[index] << endl;
+        }
+        string output = getOption(args, "--out", "checkers_eval.params");
+        if (!params.save(output)) {
+            cout << "cannot write " << output << endl;
+            return 1;
+        }
+        cout << "time: " << seconds * 1000.0 << "ms, wrote " << output << endl;
+        return 0;
+    }
+    
+    if (mode == "positions") {
+        // خواندن فایل موقعیت (باینری فشرده یا FEN متنی) و تبدیل اختیاری به باینری
+        string input = getOption(args, "--in", "");
+        string output = getOption(args, "--out", "");
+        unique_ptr<PositionWriter> writer;
+        if (!output.empty()) {
+            writer = make_unique<PositionWriter>(output);
+            if (!writer->isOpen()) {
+                cout << "cannot write " << output << endl;
+                return 1;
             }
-            
-            // دریافت حرکت
-            Move move;
-            if (game.getCurrentPlayer() == PieceType::BLACK_PIECE) {move = getAgentMove(agent1.get(), PieceType::BLACK_PIECE, display);
-            } else {
-                move = getAgentMove(agent2.get(), PieceType::WHITE_PIECE, display);
+        }
+        
+        // آمار بدون ساخت بازی: شمارش مستقیم روی بیت‌های فشرده، و حرکت و ماده
+        // به صورت دسته‌ای با analyzeBatch
+        size_t count = 0, white_to_move = 0, pieces = 0, kings = 0, invalid = 0;
+        size_t with_captures = 0, blocked = 0, simple_moves = 0;
+        double material = 0.0;
+        BoardBatch batch;
+        BoardBatchResult batch_result;
+        auto flushBatch = [&]() {
+            analyzeBatch(batch, batch_result);
+            for (size_t i = 0; i < batch.size(); i++) {
+                with_captures += batch_result.jumpers[i] != 0;
+                blocked += batch_result.legalFrom(i) == 0;
+                simple_moves += batch_result.jumpers[i] ? 0 : batch_result.simple_moves[i];
+                material += batch_result.material[i];
             }
-            
-            if (move.to.empty()) {
-                cout << "هیچ حرکت معتبری وجود ندارد!" << endl;
-                break;
+            batch.clear();
+        };
+        auto account = [&](uint64_t packed) {
+            count++;
+            white_to_move += packed >> 63;
+            for (int square = 0; square < CheckersGame::SQUARES; square++) {
+                int code = (packed >> (3 * square)) & 7;
+                pieces += code != 0;
+                kings += code >= 3;
             }
-            
-            // ذخیره وضعیت قبل از حرکت برای یادگیری
-            move.board_before = game.getBoardKey();
-            game_history.push_back(move);
-            // اعمال حرکت
-            game.applyMove(move);
-            
-            if (display) {
-                cout << "move from" << move.from.row << "," << move.from.col 
-                     << "to" << move.to.back().row << "," << move.to.back().col << ")" << endl;
-                
-                if (!move.captured.empty()) {
-                    cout << "delete checkers ";
-                    for (const auto& cap : move.captured) {
-                        cout << "(" << cap.row << "," << cap.col << ") ";
-                    }cout << endl;
+            batch.add(packed);
+            if (batch.size() == 4096) flushBatch();
+            if (writer) writer->write(packed);
+        };
+        
+        auto start = chrono::steady_clock::now();
+        PositionReader reader(input);
+        if (reader.isOpen()) {
+            cout << "binary file, " << reader.size() << " positions"
+                 << (reader.isMapped() ? " (memory-mapped)" : " (chunked)") << endl;
+            reader.forEach(account);
+        } else {
+            CheckersGame game;
+            size_t lines = PositionReader::forEachFenLine(input, [&](const string& line) {
+                if (game.setFromFen(line)) {
+                    account(game.pack());
+                } else {
+                    invalid++;
                 }
-                
-                game.printBoard();
+            });
+            if (lines == 0) {
+                cout << "no positions in " << input << endl;
+                return 1;
             }
         }
+        flushBatch();
+        if (writer) writer->flush();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
         
-        // نمایش نتیجه
-        if (display) {
-            PieceType winner = game.getWinner();
-            if (winner == PieceType::EMPTY) {
-                cout << "\n draw" << endl;
-            } else {
-                string winner_name = (winner == PieceType::BLACK_PIECE) ? "black" : "white";
-                cout << "\n player " << winner_name <<"win" << endl;}
+        size_t quiet = count - with_captures;
+        cout << "positions: " << count << " (invalid " << invalid << ")"
+             << ", white to move: " << white_to_move
+             << ", mean pieces: " << (count ? static_cast<double>(pieces) / count : 0.0)
+             << ", mean kings: " << (count ? static_cast<double>(kings) / count : 0.0) << endl;
+        cout << "side to move: capture in " << with_captures << ", no move in " << blocked
+             << ", mean quiet moves: " << (quiet ? static_cast<double>(simple_moves) / quiet : 0.0)
+             << ", mean material: " << (count ? material / count : 0.0)
+             << " (" << isaName(kernels().isa) << " kernels)" << endl;
+        cout << "time: " << seconds * 1000.0 << "ms ("
+             << static_cast<long long>(seconds > 0 ? count / seconds : 0) << " positions/s)" << endl;
+        if (writer) {
+            cout << "wrote " << writer->count() << " positions to " << output << endl;
         }
-        double black_result = 0.0;
-        if (game.getWinner() == PieceType::BLACK_PIECE) black_result = 1.0;
-        else if (game.getWinner() == PieceType::WHITE_PIECE) black_result = -1.0;
-        
-        if (auto learning_agent = dynamic_cast<LearningAgent*>(agent1.get())) {
-            learning_agent->learnFromGame(game_history, black_result);
+        return 0;
+    }
+    
+    if (mode == "analyze") {
+        // تحلیل چندخطی موازی؛ یک سطر JSON برای هر موقعیت به ترتیب ورودی
+        vector<uint64_t> positions;
+        size_t invalid = 0;
+        CheckersGame game;
+        string fen = getOption(args, "--fen", "");
+        string input = getOption(args, "--in", "");
+        if (!fen.empty()) {
+            if (!game.setFromFen(fen)) {
+                cout << "invalid fen: " << fen << endl;
+                return 1;
+            }
+            positions.push_back(game.pack());
+        } else {
+            positions = PositionReader::readAll(input, invalid);
+        }
+        if (positions.empty()) {
+            cout << "no positions to analyze (use --in FILE or --fen FEN)" << endl;
+            return 1;
         }
         
-        if (auto learning_agent = dynamic_cast<LearningAgent*>(agent2.get())) {
-            learning_agent->learnFromGame(game_history, -black_result);
+        string output = getOption(args, "--out", "");
+        ofstream out_file;
+        if (!output.empty()) {
+            out_file.open(output);
+            if (!out_file) {
+                cout << "cannot write " << output << endl;
+                return 1;
+            }
         }
+        ostream& out = output.empty() ? cout : out_file;
+        // بدون --out خلاصه به stderr می‌رود تا stdout فقط JSON باشد
+        ostream& summary = output.empty() ? cerr : cout;
+        
+        BatchAnalyzer analyzer(stoi(getOption(args, "--threads", "0")),
+                               stoi(getOption(args, "--multipv", "3")),
+                               stoi(getOption(args, "--depth", "6")),
+                               getOption(args, "--eval", "advanced"),
+                               stoi(getOption(args, "--movetime", "0")));
+        long long total_nodes = 0;
+        auto start = chrono::steady_clock::now();
+        analyzer.run(positions, [&](const BatchAnalysisItem& item) {
+            out << analysisToJson(item) << "\n";
+            total_nodes += item.result.nodes;
+        });
+        out.flush();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        summary << "analyzed " << positions.size() << " positions (invalid " << invalid << ") with "
+                << analyzer.getThreads() << " threads in " << seconds << "s ("
+                << static_cast<long long>(positions.size() / max(seconds, 1e-9)) << " positions/s, "
+                << static_cast<long long>(total_nodes / max(seconds, 1e-9)) << " nodes/s)" << endl;
+        return 0;
     }
-    // دریافت حرکت از عامل یا انسان
-    Move getAgentMove(CheckersAgent* agent, PieceType player, bool display) {
-        vector<Move> moves = game.getAllValidMoves(player);
+    
+    if (mode == "solve") {
+        // حل df-pn؛ بدون ورودی موقعیت شروع
+        vector<string> fens;
+        string fen = getOption(args, "--fen", "");
+        string input = getOption(args, "--in", "");
+        if (!fen.empty()) {
+            fens.push_back(fen);
+        } else if (!input.empty()) {
+            PositionReader reader(input);
+            if (reader.isOpen()) {
+                CheckersGame game;
+                reader.forEach([&](uint64_t packed) {
+                    if (game.unpack(packed)) fens.push_back(game.toFen());
+                });
+            } else {
+                PositionReader::forEachFenLine(input, [&](const string& line) { fens.push_back(line); });
+            }
+        } else {
+            fens.push_back(CheckersGame().toFen());
+        }
         
-        if (moves.empty()) {
-            return Move();
+        string export_file = getOption(args, "--export", "");
+        shared_ptr<SolvedTable> solved_table;
+        if (!export_file.empty()) {
+            solved_table = loadSolvedTable(export_file);
+            if (!solved_table) {
+                solved_table = make_shared<SolvedTable>();
+            }
         }
         
-        if (agent == nullptr) { // حرکت انسان
-            if (display) {
-                cout << "moves:"<< endl;
-                for (size_t i = 0; i < moves.size(); i++) {
-                    const auto& move = moves[i];
-                    cout << i << ": from" << move.from.row << "," << move.from.col 
-                         << "to" << move.to.back().row << "," << move.to.back().col << ") ";
-                    cout << (move.is_capture ? "(capture)" : "(basic)") << endl;
-                }
+        DfpnSolver solver(stoi(getOption(args, "--threads", "0")),
+                          stoul(getOption(args, "--tt-mb", "256")),
+                          stoll(getOption(args, "--max-nodes", "0")));
+        const char* value_names[] = {"loss", "draw", "win", "unknown"};
+        for (const auto& line : fens) {
+            CheckersGame game;
+            if (!game.setFromFen(line)) {
+                cout << "invalid fen: " << line << endl;
+                continue;
             }
-            
-            int choice;
-            while (true) {
-                cout << "choose number";
-                cin >> choice;
-                
-                if (choice >= 0 && choice < static_cast<int>(moves.size())) {return moves[choice];
-                } else {
-                    cout << "شماره حرکت نامعتبر است." << endl;
-                }
+            SolveResult result = solver.solve(game);
+            cout << game.toFen() << " value=" << value_names[static_cast<int>(result.value) + 1]
+                 << " proof=" << result.proof_size << " nodes=" << result.nodes
+                 << " time=" << result.elapsed_ms << "ms threads=" << solver.getThreads();
+            if (!result.best_move.to.empty()) {
+                cout << " best=" << moveToString(result.best_move);
             }
-        } else { // حرکت عامل
-            if (display) {
-                cout << agent->getName() << " in calculation" << endl;
+            cout << endl;
+            if (solved_table) {
+                DfpnSolver::exportResult(game, result, *solved_table);
             }
-            
-            auto start = chrono::high_resolution_clock::now();
-            Move move = agent->getMove(game);
-            auto end = chrono::high_resolution_clock::now();
-            auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
-            
-            if (display) {
-                cout << "time of calculation:" << duration.count() << " mlsecend" << endl;
-                
-                if (auto minimax_agent = dynamic_cast<MinimaxAgent*>(agent)) {
-                    cout << "number of nudes " 
-                         << minimax_agent->getNodesExpanded() << endl;
-                }
+        }
+        if (solved_table) {
+            if (!saveSolvedTable(export_file, *solved_table)) {
+                cout << "cannot write " << export_file << endl;
+                return 1;
             }
-            
-            return move;}
+            cout << "exported " << solved_table->size() << " solved positions to " << export_file << endl;
+        }
+        return 0;
     }
-    // اجرای آزمایش‌های تجربی
-    void runExperiments(int num_games = 10, const string& agent1_type = "minimax",
-                       const string& agent2_type = "random", int depth = 3,
-                       bool use_alpha_beta = true) {
-        struct Results {
-            int black_wins = 0;
-            int white_wins = 0;
-            int draws = 0;
-            double avg_moves = 0;
-            long long total_nodes = 0;
-        } results;
-        cout  << num_games << " game between " 
-             << agent1_type << " black and" << agent2_type << " (white)" << endl;
-        cout << "depth search: " << depth << ", Alpha-Beta: " 
-             << (use_alpha_beta ? "active" : "inactive") << endl;
+    
+    if (mode == "experiment") {
+        // تورنمنت بدون منو با خروجی JSON/CSV
+        GameManager manager;
+        manager.setResultsOutput(getOption(args, "--out", "experiment_results"));
+        manager.setSearchLogging(getOption(args, "--log-search", "no") == "yes");
+        manager.setMasterSeed(stoull(getOption(args, "--seed", "1")));
+        int games = stoi(getOption(args, "--games", "10"));
+        string black = getOption(args, "--black", "minimax");
+        string white = getOption(args, "--white", "random");
+        int depth = stoi(getOption(args, "--depth", "3"));
+        bool alpha_beta = getOption(args, "--alpha-beta", "yes") == "yes";
+        string variant = getOption(args, "--variant", "6x6");
+        if (variant == RulesEnglish8x8::NAME) {
+            manager.runVariantExperiments<EnglishCheckersGame>(games, black, white, depth, alpha_beta);
+        } else if (variant == RulesFlying8x8::NAME) {
+            manager.runVariantExperiments<FlyingCheckersGame>(games, black, white, depth, alpha_beta);
+        } else if (variant == Rules6x6::NAME) {
+            manager.runExperiments(games, black, white, depth, alpha_beta);
+        } else {
+            cout << "unknown variant: " << variant << endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (mode == "distribute") {
+        // کار روی چند پردازه کارگر: بازی‌های experiment یا موقعیت‌های analyze (با --in)
+#ifdef CHECKERS_HAVE_PROCESSES
+        WorkerPoolOptions options;
+        options.workers = stoi(getOption(args, "--workers", "0"));
+        if (options.workers <= 0) {
+            options.workers = max(1u, thread::hardware_concurrency());
+        }
+        options.max_restarts = stoi(getOption(args, "--max-restarts", "8"));
+        options.job_timeout_s = stod(getOption(args, "--job-timeout", "0"));
+        options.pin = getOption(args, "--pin", "no") == "yes";
         
-        for (int game_num = 0; game_num < num_games; game_num++) {
-            cout << "\n number game" << game_num + 1 << ":" << endl;
-            
-            // تنظیم بازی
-            setupGame("agent_vs_agent", agent1_type, agent2_type, depth, use_alpha_beta);
-            // اجرای بازی
-            playGame(false);
-            
-            // جمع‌آوری نتایج
-            PieceType winner = game.getWinner();
-            if (winner == PieceType::BLACK_PIECE) {
-                results.black_wins++;
-                cout << "  نتیجه: " << agent1_type << " (سیاه) برنده شد";
-            } else if (winner == PieceType::WHITE_PIECE) {
-                results.white_wins++;
-                cout << "  نتیجه: " << agent2_type << " (سفید) برنده شد";
-            } else {
-                results.draws++;
-                cout << "  draw";
+        string input = getOption(args, "--in", "");
+        if (!input.empty()) {
+            size_t invalid = 0;
+            vector<uint64_t> positions = PositionReader::readAll(input, invalid);
+            if (positions.empty()) {
+                cout << "no positions in " << input << endl;
+                return 1;
             }
-            int moves_count = game.getMoveHistory().size();
-            results.avg_moves += moves_count;
-            cout << " (" << moves_count << " move" << endl;
-            
-            // جمع‌آوری تعداد گره‌ها
-            if (auto minimax_agent = dynamic_cast<MinimaxAgent*>(agent1.get())) {
-                results.total_nodes += minimax_agent->getNodesExpanded();
+            string output = getOption(args, "--out", "");
+            ofstream out_file;
+            if (!output.empty()) {
+                out_file.open(output);
+                if (!out_file) {
+                    cout << "cannot write " << output << endl;
+                    return 1;
+                }
+            }
+            if (invalid > 0) {
+                cerr << "skipped " << invalid << " invalid lines" << endl;
             }
+            runDistributedAnalysis(positions, options, stoi(getOption(args, "--depth", "6")),
+                                   stoi(getOption(args, "--multipv", "3")),
+                                   getOption(args, "--eval", "advanced"),
+                                   stoi(getOption(args, "--movetime", "0")),
+                                   output.empty() ? cout : out_file, output.empty() ? cerr : cout);
+            return 0;
         }
         
-        // محاسبه میانگین‌ها
-        results.avg_moves /= num_games;
-        // نمایش نتایج کلی
-        cout << "\n results:" << endl;
-        cout << "black wins" << agent1_type << "): " << results.black_wins << endl;
-        cout << "white wins:" << agent2_type << "): " << results.white_wins << endl;
-        cout << "numbers of draws" << results.draws << endl;
-        cout << "mean of moves:" << results.avg_moves << endl;
-        
-        if (results.total_nodes > 0) {
-            cout << "mean" 
-                 << results.total_nodes / num_games << endl;
+        GameManager manager;
+        manager.setResultsOutput(getOption(args, "--out", "experiment_results"));
+        manager.setMasterSeed(stoull(getOption(args, "--seed", "1")));
+        runDistributedExperiments(manager, options, stoi(getOption(args, "--games", "10")),
+                                  getOption(args, "--black", "minimax"),
+                                  getOption(args, "--white", "random"),
+                                  stoi(getOption(args, "--depth", "3")),
+                                  getOption(args, "--alpha-beta", "yes") == "yes",
+                                  getOption(args, "--log-search", "no") == "yes");
+        return 0;
+#else
+        cout << "distribute needs fork and Unix sockets (POSIX systems only)" << endl;
+        return 1;
+#endif
+    }
+    
+    if (mode == "match") {
+        // مسابقه با گشایش‌های تصادفی، Elo و SPRT
+        GameManager manager;
+        manager.setResultsOutput("");
+        manager.runMatch(getOption(args, "--a", "minimax"), getOption(args, "--b", "greedy"),
+                         stoi(getOption(args, "--games", "400")),
+                         stoi(getOption(args, "--depth-a", "3")),
+                         stoi(getOption(args, "--depth-b", "3")),
+                         stod(getOption(args, "--elo0", "0")),
+                         stod(getOption(args, "--elo1", "20")),
+                         stod(getOption(args, "--alpha", "0.05")),
+                         stod(getOption(args, "--beta", "0.05")),
+                         stoi(getOption(args, "--opening-plies", "4")),
+                         stoull(getOption(args, "--seed", "1")));
+        return 0;
+    }
+    
+    if (mode == "bench") {
+        // ریزسنجه‌ها با خلاصه JSON
+        vector<size_t> sizes;
+        string size_list = getOption(args, "--entries", "10000,1000000");
+        size_t begin = 0;
+        while (begin < size_list.size()) {
+            size_t end = size_list.find(',', begin);
+            if (end == string::npos) end = size_list.size();
+            sizes.push_back(stoul(size_list.substr(begin, end - begin)));
+            begin = end + 1;
         }
+        runMicroBenchmarks(stod(getOption(args, "--min-time", "200")),
+                           getOption(args, "--filter", ""),
+                           getOption(args, "--json", "bench_results.json"), sizes);
+        return 0;
     }
+    
+    cout << "unknown mode: " << mode << endl;
+    cout << "modes: train-td [--batches N] [--games N] [--threads N] [--alpha A] "
+            "[--lambda L] [--epsilon E] [--seed S] [--weights FILE] [--resume yes]" << endl;
+    cout << "       perft [--depth N] [--position start|chain|kings|promo|all] [--divide yes] "
+            "[--threads N] [--bulk no] [--variant 6x6|8x8|flying]" << endl;
+    cout << "       experiment [--games N] [--black TYPE] [--white TYPE] [--depth D] "
+            "[--alpha-beta no] [--out BASE] [--log-search yes] [--seed S] [--variant 6x6|8x8|flying]" << endl;
+    cout << "       match [--a TYPE] [--b TYPE] [--games N] [--depth-a D] [--depth-b D] "
+            "[--elo0 E] [--elo1 E] [--alpha A] [--beta B] [--opening-plies N] [--seed S]" << endl;
+    cout << "       bench [--filter TEXT] [--min-time MS] [--json FILE] [--entries N,N]" << endl;
+    cout << "       positions --in FILE [--out FILE]" << endl;
+    cout << "       solve [--fen FEN | --in FILE] [--threads N] [--tt-mb M] [--max-nodes N] "
+            "[--export FILE]" << endl;
+    cout << "       analyze (--in FILE | --fen FEN) [--depth D] [--multipv K] [--threads N] "
+            "[--eval NAME] [--movetime MS] [--out FILE]" << endl;
+    cout << "       selfplay [--games N] [--threads N] [--depth D] [--eval NAME] [--random-plies N] "
+            "[--epsilon E] [--max-plies N] [--seed S] [--out FILE] | selfplay --in FILE" << endl;
+    cout << "       tune [--in FILE] [--eval advanced|positional|basic] [--iterations N] [--lr X] "
+            "[--threads N] [--max-positions N] [--out FILE]" << endl;
+    cout << "       distribute [--workers N] [--max-restarts N] [--job-timeout S] [--pin yes] "
+            "(experiment options | --in FILE analyze options)" << endl;
+    cout << "       protocol   (line protocol on stdin/stdout; see README)" << endl;
+    cout << "       every mode: [--solved FILE] plays solved positions from a CKSV table" << endl;
+    return 1;
+}
+
+// ============================================================================
+// رابط C پایدار برای کتابخانه اشتراکی (-DCHECKERS_SHARED_LIBRARY)
+// ============================================================================
+
+// موقعیت‌ها در مرز ABI به شکل فشرده 64 بیتی (CheckersGame::pack) رد و بدل
+// می‌شوند و هر فراخوانی بدون حالت است؛ پس فراخوانی از چند نخ ایمن است.
+// قانون‌های وابسته به تاریخچه (تکرار و 30 نیم‌حرکت بدون capture) بر عهده فراخواننده‌اند.
+// ساخت (یک خط):
+//   g++ -O2 -std=c++17 -shared -fPIC -fvisibility=hidden -pthread -DCHECKERS_SHARED_LIBRARY
+//       lastprojAI.cxx -o libcheckers.so
+
+#if defined(_WIN32)
+#define CKR_API extern "C" __declspec(dllexport)
+#else
+#define CKR_API extern "C" __attribute__((visibility("default")))
+#endif
+
+const int CKR_ABI_VERSION = 2;
+const int CKR_MAX_PATH = 15;
+
+// کدهای بازگشتی؛ مقادیر منفی خطا هستند
+const int CKR_OK = 0;
+const int CKR_ERROR_ARGUMENT = -1;       // اشاره‌گر تهی، موقعیت نامعتبر یا نام ارزیاب ناشناخته
+const int CKR_ERROR_ILLEGAL_MOVE = -2;
+const int CKR_ERROR_BUFFER = -3;         // بافر خروجی کوچک است
+const int CKR_ERROR_INTERNAL = -4;       // استثنای ++C که از مرز ABI عبور نمی‌کند
+
+// حرکت: شماره خانه‌های مسیر (1..18)، از مبدأ تا آخرین خانه فرود
+struct ckr_move {
+    uint8_t length;                      // 0: بدون حرکت
+    uint8_t squares[CKR_MAX_PATH];
+};
+
+struct ckr_search_result {
+    ckr_move best_move;
+    int32_t depth;                       // آخرین عمق کامل
+    double score;                        // بر حسب مهره، از دید بازیکن در نوبت
+    uint64_t nodes;
 };
-int main() {
+
+static_assert(sizeof(ckr_move) == 16, "ckr_move layout is part of the ABI");
+static_assert(sizeof(ckr_search_result) == 40, "ckr_search_result layout is part of the ABI");
+
+namespace ckr_detail {
+
+bool knownEval(const char* eval) {
+    static const char* names[] = {"basic", "advanced", "positional", "learned", "nnue"};
+    for (const char* name : names) {
+        if (eval != nullptr && strcmp(eval, name) == 0) return true;
+    }
+    return false;
+}
+
+ckr_move encodeMove(const Move& move) {
+    ckr_move out{};
+    out.squares[out.length++] = static_cast<uint8_t>(CheckersGame::squareNumber(move.from.row, move.from.col));
+    for (const auto& pos : move.to) {
+        if (out.length < CKR_MAX_PATH) {
+            out.squares[out.length++] = static_cast<uint8_t>(CheckersGame::squareNumber(pos.row, pos.col));
+        }
+    }
+    return out;
+}
+
+bool sameMove(const Move& move, const ckr_move& path) {
+    ckr_move encoded = encodeMove(move);
+    return encoded.length == path.length &&
+           memcmp(encoded.squares, path.squares, path.length) == 0;
+}
+
+int legalMoves(uint64_t position, ckr_move* out, int capacity) {
+    CheckersGame game;
+    if (!game.unpack(position) || capacity < 0 || (out == nullptr && capacity > 0)) {
+        return CKR_ERROR_ARGUMENT;
+    }
+    if (game.isGameOver()) {
+        return 0;
+    }
+    vector<Move> moves = game.getAllValidMoves(game.getCurrentPlayer());
+    for (int i = 0; i < static_cast<int>(moves.size()) && i < capacity; i++) {
+        out[i] = encodeMove(moves[i]);
+    }
+    return static_cast<int>(moves.size());
+}
+
+// ارزیاب‌های آموخته یک بار از فایل‌های پیش‌فرض MinimaxAgent خوانده می‌شوند و
+// پس از آن فقط خواندنی و بین نخ‌ها مشترک‌اند
+const LinearEvaluator& learnedEvaluator() {
+    static const unique_ptr<LinearEvaluator> evaluator = []() {
+        auto loaded = make_unique<LinearEvaluator>();
+        loaded->loadWeights("checkers_weights.dat");
+        return loaded;
+    }();
+    return *evaluator;
+}
+
+const NNUENetwork& nnueNetwork() {
+    static const unique_ptr<NNUENetwork> network = []() {
+        auto loaded = make_unique<NNUENetwork>();
+        loaded->loadWeights("checkers_nnue.dat");
+        return loaded;
+    }();
+    return *network;
+}
+
+// همان مقدار MinimaxAgent::evaluate برای بازیکن در نوبت، بدون ساختن عامل
+double staticEvaluate(const CheckersGame& game, const char* eval) {
+    PieceType player = game.getCurrentPlayer();
+    if (game.isGameOver()) {
+        PieceType winner = game.getWinner();
+        return winner == player ? 1000.0 : (winner == PieceType::EMPTY ? 0.0 : -1000.0);
+    }
+    if (strcmp(eval, "advanced") == 0) {
+        return MinimaxAgent::evaluateAdvanced(game, player);
+    }
+    if (strcmp(eval, "positional") == 0) {
+        return MinimaxAgent::evaluatePositional(game, player);
+    }
+    if (strcmp(eval, "learned") == 0) {
+        return learnedEvaluator().evaluate(game, player);
+    }
+    if (strcmp(eval, "nnue") == 0) {
+        NNUEAccumulator acc;
+        nnueNetwork().refresh(game.getBoard(), acc);
+        double black_score = nnueNetwork().evaluate(acc);
+        return player == PieceType::BLACK_PIECE ? black_score : -black_score;
+    }
+    return MinimaxAgent::evaluateBasic(game, player);
+}
+
+void fillResult(const AnalysisResult& analysis, ckr_search_result* out) {
+    *out = ckr_search_result{};
+    out->depth = analysis.depth;
+    out->nodes = static_cast<uint64_t>(analysis.nodes);
+    if (!analysis.lines.empty()) {
+        out->best_move = encodeMove(analysis.lines[0].move);
+        out->score = analysis.lines[0].score;
+    }
+}
+
+// تبدیل استثنا به کد خطا
+template<class Fn>
+int guarded(Fn&& fn) {
+    try {
+        return fn();
+    } catch (...) {
+        return CKR_ERROR_INTERNAL;
+    }
+}
+
+}  // namespace ckr_detail
+
+CKR_API int ckr_abi_version(void) { return CKR_ABI_VERSION; }
+
+CKR_API uint64_t ckr_start_position(void) { return CheckersGame().pack(); }
+
+// cells: 36 خانه سطر به سطر با کدهای PieceType؛ خانه‌های روشن نادیده گرفته می‌شوند
+CKR_API int ckr_from_cells(const int8_t* cells, int white_to_move, uint64_t* out) {
+    if (cells == nullptr || out == nullptr) {
+        return CKR_ERROR_ARGUMENT;
+    }
+    uint64_t packed = white_to_move ? (uint64_t(1) << 63) : 0;
+    for (int square = 1; square <= CheckersGame::SQUARES; square++) {
+        Position pos = CheckersGame::squarePosition(square);
+        int code = cells[pos.row * CheckersGame::SIZE + pos.col];
+        if (code < 0 || code > static_cast<int>(PieceType::WHITE_KING)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        packed |= uint64_t(code) << (3 * (square - 1));
+    }
+    *out = packed;
+    return CKR_OK;
+}
+
+// خانه‌های روشن با -1 (PieceType::INVALID) پر می‌شوند؛ خروجی: 1 اگر نوبت سفید است
+CKR_API int ckr_to_cells(uint64_t position, int8_t* cells) {
+    CheckersGame game;
+    if (cells == nullptr || !game.unpack(position)) {
+        return CKR_ERROR_ARGUMENT;
+    }
+    const auto& board = game.getBoard();
+    for (int row = 0; row < CheckersGame::SIZE; row++) {
+        for (int col = 0; col < CheckersGame::SIZE; col++) {
+            cells[row * CheckersGame::SIZE + col] = game.isBlackSquare({row, col})
+                ? static_cast<int8_t>(board[row][col]) : static_cast<int8_t>(PieceType::INVALID);
+        }
+    }
+    return game.getCurrentPlayer() == PieceType::WHITE_PIECE ? 1 : 0;
+}
+
+CKR_API int ckr_from_fen(const char* fen, uint64_t* out) {
+    return ckr_detail::guarded([&]() {
+        CheckersGame game;
+        if (fen == nullptr || out == nullptr || !game.setFromFen(fen)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        *out = game.pack();
+        return CKR_OK;
+    });
+}
+
+// مانند snprintf: طول کامل FEN را برمی‌گرداند و حداکثر size-1 نویسه می‌نویسد
+CKR_API int ckr_to_fen(uint64_t position, char* buffer, int size) {
+    return ckr_detail::guarded([&]() {
+        CheckersGame game;
+        if (!game.unpack(position) || size < 0 || (buffer == nullptr && size > 0)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        string fen = game.toFen();
+        if (size > 0) {
+            size_t written = min(fen.size(), static_cast<size_t>(size - 1));
+            memcpy(buffer, fen.data(), written);
+            buffer[written] = '\0';
+        }
+        return static_cast<int>(fen.size());
+    });
+}
+
+// 0: ادامه دارد، 1: برد سیاه، 2: برد سفید (کدهای PieceType)
+CKR_API int ckr_status(uint64_t position) {
+    return ckr_detail::guarded([&]() {
+        CheckersGame game;
+        if (!game.unpack(position)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        return game.isGameOver() ? static_cast<int>(game.getWinner()) : 0;
+    });
+}
+
+// تعداد کل حرکات را برمی‌گرداند و حداکثر capacity حرکت می‌نویسد
+CKR_API int ckr_legal_moves(uint64_t position, ckr_move* moves, int capacity) {
+    return ckr_detail::guarded([&]() { return ckr_detail::legalMoves(position, moves, capacity); });
+}
+
+// moves[i * capacity ...] حرکات موقعیت i؛ counts[i] تعداد کل یا کد خطای آن موقعیت
+CKR_API int ckr_legal_moves_batch(const uint64_t* positions, int count, ckr_move* moves,
+                                  int capacity, int32_t* counts) {
+    if (count < 0 || (count > 0 && (positions == nullptr || counts == nullptr))) {
+        return CKR_ERROR_ARGUMENT;
+    }
+    int status = CKR_OK;
+    for (int i = 0; i < count; i++) {
+        ckr_move* out = moves != nullptr ? moves + static_cast<size_t>(i) * capacity : nullptr;
+        counts[i] = ckr_legal_moves(positions[i], out, capacity);
+        if (counts[i] > capacity && status == CKR_OK) {
+            status = CKR_ERROR_BUFFER;
+        } else if (counts[i] < 0 && status == CKR_OK) {
+            status = counts[i];
+        }
+    }
+    return status;
+}
+
+CKR_API int ckr_apply_move(uint64_t position, const ckr_move* move, uint64_t* out) {
+    return ckr_detail::guarded([&]() {
+        CheckersGame game;
+        if (move == nullptr || out == nullptr || move->length > CKR_MAX_PATH || !game.unpack(position)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        if (game.isGameOver()) {
+            return CKR_ERROR_ILLEGAL_MOVE;
+        }
+        for (const auto& legal : game.getAllValidMoves(game.getCurrentPlayer())) {
+            if (ckr_detail::sameMove(legal, *move)) {
+                game.applyMove(legal);
+                *out = game.pack();
+                return CKR_OK;
+            }
+        }
+        return CKR_ERROR_ILLEGAL_MOVE;
+    });
+}
+
+// ارزیابی ایستا از دید بازیکن در نوبت
+CKR_API int ckr_evaluate(uint64_t position, const char* eval, double* score) {
+    return ckr_detail::guarded([&]() {
+        CheckersGame game;
+        if (score == nullptr || !ckr_detail::knownEval(eval) || !game.unpack(position)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        *score = ckr_detail::staticEvaluate(game, eval);
+        return CKR_OK;
+    });
+}
+
+// جستجوی عمیق‌شونده تا depth؛ movetime_ms > 0 زمان را هم محدود می‌کند
+CKR_API int ckr_search(uint64_t position, int depth, const char* eval, int movetime_ms,
+                       ckr_search_result* result) {
+    return ckr_detail::guarded([&]() {
+        CheckersGame game;
+        if (result == nullptr || depth < 1 || !ckr_detail::knownEval(eval) || !game.unpack(position)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        *result = ckr_search_result{};
+        if (game.isGameOver()) {
+            return CKR_OK;
+        }
+        SearchLimits limits;
+        limits.depth = depth;
+        limits.movetime_ms = movetime_ms;
+        MinimaxAgent agent(game.getCurrentPlayer(), depth, true, eval);
+        ckr_detail::fillResult(agent.analyze(game, 1, limits), result);
+        return CKR_OK;
+    });
+}
+
+// جستجوی موازی چند موقعیت با BatchAnalyzer؛ threads <= 0 یعنی همه هسته‌ها.
+// statuses[i] (اختیاری) کد موقعیت i است؛ خروجی اولین خطای موقعیت‌ها یا CKR_OK
+CKR_API int ckr_search_batch(const uint64_t* positions, int count, int depth, const char* eval,
+                             int movetime_ms, int threads, ckr_search_result* results,
+                             int32_t* statuses) {
+    return ckr_detail::guarded([&]() {
+        if (count < 0 || (count > 0 && (positions == nullptr || results == nullptr)) ||
+            depth < 1 || !ckr_detail::knownEval(eval)) {
+            return CKR_ERROR_ARGUMENT;
+        }
+        int status = CKR_OK;
+        CheckersGame game;
+        for (int i = 0; i < count; i++) {
+            int position_status = game.unpack(positions[i]) ? CKR_OK : CKR_ERROR_ARGUMENT;
+            if (statuses != nullptr) {
+                statuses[i] = position_status;
+            }
+            if (position_status != CKR_OK && status == CKR_OK) {
+                status = position_status;
+            }
+        }
+        BatchAnalyzer analyzer(threads, 1, depth, eval, movetime_ms);
+        analyzer.run(vector<uint64_t>(positions, positions + count), [&](const BatchAnalysisItem& item) {
+            ckr_detail::fillResult(item.result, &results[item.index]);
+        });
+        return status;
+    });
+}
+
+#ifndef CHECKERS_SHARED_LIBRARY
+int main(int argc, char* argv[]) {
+#ifdef CHECKERS_BENCH
+    // build سنجه مستقیماً ریزسنجه‌ها را اجرا می‌کند
+    vector<string> bench_args = {"bench"};
+    bench_args.insert(bench_args.end(), argv + 1, argv + argc);
+    return runCommandLine(bench_args);
+#endif
+    if (argc > 1) {
+        return runCommandLine(vector<string>(argv + 1, argv + argc));
+    }
+    
     GameManager manager;
     
     // تنظیم زبان فارسی در کنسول (ویندوز)
@@ -1289,13 +8694,6 @@ int main() {
                 int agent2_choice;
                 cin >> agent2_choice;
                 
-                string agent2_type;
-                switch (agent2_choice) {
-                    case 1: agent2_type = "random"; break;
-                    case 2: agent2_type = "greedy"; break;
-                    int agent2_choice;
-                cin >> agent2_choice;
-                
                 string agent2_type;
                 switch (agent2_choice) {
                     case 1: agent2_type = "random"; break;
@@ -1312,9 +8710,10 @@ int main() {
             
             case 3: {
                 // آزمایش‌های تجربی
-                cout << "1.moghayese baa minmax bedoon alphbeta<< endl;
+                cout << "1.moghayese baa minmax bedoon alphbeta" << endl;
                 cout << "2. moghaayese agent haaye mokhtalef" << endl;
                 cout << "3. tasir omgh" << endl;
+                cout << "4. SPRT match (minimax d=4 vs minimax d=3)" << endl;
                 int exp_choice;
                 cin >> exp_choice;
                 
@@ -1333,6 +8732,9 @@ int main() {
                             manager.runExperiments(3, "minimax", "greedy", depth, true);
                         }
                         break;
+                    case 4:
+                        manager.runMatch("minimax", "minimax", 400, 4, 3);
+                        break;
                 }
                 break;
             }
@@ -1347,4 +8749,5 @@ int main() {
           } while (choice != 4);
     
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,4 +1,7 @@
 import copy
+import ctypes
+import os
+import sys
 
 # --- تنظیمات اولیه ---
 EMPTY = 0
@@ -151,6 +154,134 @@ def choose_move(board,player,depth=3,eval_func=evaluate1):
             if score<best_score: best_score,best_move=score,move
     return best_move,nodes[0]
 
+# --- موتور بومی (libcheckers از lastprojAI.cxx با -DCHECKERS_SHARED_LIBRARY) ---
+# موتور ++C سیاه را در ردیف‌های 0 و 1 قرار می‌دهد؛ خانه (r,c) این فایل همان (5-r,5-c) آنجاست.
+# قواعد موتور با این فایل یکی نیست (قانون بیشترین capture، ارزیاب basic موتور به جای evaluate1)،
+# پس توابع بازی فقط با CHECKERS_NATIVE=1 جایگزین می‌شوند؛ توابع دسته‌ای همیشه از کتابخانه استفاده می‌کنند.
+CKR_MAX_PATH=15
+CKR_ABI_VERSION=2
+CKR_ERROR_BUFFER=-3
+
+class CkrMove(ctypes.Structure):
+    _fields_=[('length',ctypes.c_uint8),('squares',ctypes.c_uint8*CKR_MAX_PATH)]
+
+class CkrSearchResult(ctypes.Structure):
+    _fields_=[('best_move',CkrMove),('depth',ctypes.c_int32),('score',ctypes.c_double),('nodes',ctypes.c_uint64)]
+
+def load_native():
+    names={'win32':'checkers.dll','darwin':'libcheckers.dylib'}.get(sys.platform,'libcheckers.so')
+    path=os.environ.get('CHECKERS_LIB',os.path.join(os.path.dirname(os.path.abspath(__file__)),names))
+    try: lib=ctypes.CDLL(path)
+    except OSError: return None
+    u64,i32,pu64=ctypes.c_uint64,ctypes.c_int,ctypes.POINTER(ctypes.c_uint64)
+    for name,res,args in [
+        ('ckr_abi_version',i32,[]),
+        ('ckr_from_cells',i32,[ctypes.POINTER(ctypes.c_int8),i32,pu64]),
+        ('ckr_to_cells',i32,[u64,ctypes.POINTER(ctypes.c_int8)]),
+        ('ckr_legal_moves',i32,[u64,ctypes.POINTER(CkrMove),i32]),
+        ('ckr_legal_moves_batch',i32,[pu64,i32,ctypes.POINTER(CkrMove),i32,ctypes.POINTER(ctypes.c_int32)]),
+        ('ckr_apply_move',i32,[u64,ctypes.POINTER(CkrMove),pu64]),
+        ('ckr_search',i32,[u64,i32,ctypes.c_char_p,i32,ctypes.POINTER(CkrSearchResult)]),
+        ('ckr_search_batch',i32,[pu64,i32,i32,ctypes.c_char_p,i32,i32,ctypes.POINTER(CkrSearchResult),ctypes.POINTER(ctypes.c_int32)])]:
+        fn=getattr(lib,name); fn.restype=res; fn.argtypes=args
+    return lib if lib.ckr_abi_version()==CKR_ABI_VERSION else None
+
+_lib=load_native()
+MAX_MOVES=64
+
+def to_native(board,player):
+    cells=(ctypes.c_int8*(ROWS*COLS))()
+    for r in range(ROWS):
+        for c in range(COLS):
+            cells[(ROWS-1-r)*COLS+(COLS-1-c)]=max(board[r][c],EMPTY)
+    packed=ctypes.c_uint64()
+    if _lib.ckr_from_cells(cells,1 if player==WHITE else 0,ctypes.byref(packed))!=0:
+        raise ValueError("invalid board")
+    return packed.value
+
+def from_native(packed):
+    cells=(ctypes.c_int8*(ROWS*COLS))()
+    _lib.ckr_to_cells(packed,cells)
+    return [[cells[(ROWS-1-r)*COLS+(COLS-1-c)] for c in range(COLS)] for r in range(ROWS)]
+
+def square_to_rc(square):
+    row=(square-1)//(COLS//2); col=2*((square-1)%(COLS//2))+(1-row%2)
+    return (ROWS-1-row,COLS-1-col)
+
+def rc_to_square(r,c):
+    row,col=ROWS-1-r,COLS-1-c
+    return row*(COLS//2)+col//2+1
+
+# حرکت ساده به شکل ((r,c),(nr,nc)) و زنجیره خوردن به شکل فهرست مسیر، مانند get_moves
+def move_from_native(m):
+    path=[square_to_rc(m.squares[i]) for i in range(m.length)]
+    if len(path)==2 and abs(path[0][0]-path[1][0])==1: return (path[0],path[1])
+    return path
+
+def move_to_native(move):
+    path=list(move)
+    m=CkrMove(); m.length=len(path)
+    for i,(r,c) in enumerate(path): m.squares[i]=rc_to_square(r,c)
+    return m
+
+def native_get_moves(board,player):
+    buf=(CkrMove*MAX_MOVES)()
+    n=_lib.ckr_legal_moves(to_native(board,player),buf,MAX_MOVES)
+    if n<0: raise RuntimeError(f"ckr_legal_moves failed: {n}")
+    return [move_from_native(buf[i]) for i in range(min(n,MAX_MOVES))]
+
+def native_apply_move(board,move,player):
+    out=ctypes.c_uint64()
+    if _lib.ckr_apply_move(to_native(board,player),ctypes.byref(move_to_native(move)),ctypes.byref(out))!=0:
+        raise ValueError(f"illegal move {move}")
+    return from_native(out.value)
+
+def native_is_terminal(board):
+    if _lib.ckr_legal_moves(to_native(board,BLACK),None,0)<=0: return True,WHITE
+    if _lib.ckr_legal_moves(to_native(board,WHITE),None,0)<=0: return True,BLACK
+    return False,None
+
+# جستجوی بومی فقط جای evaluate1 (ارزیاب basic موتور) را می‌گیرد
+def native_choose_move(board,player,depth=3,eval_func=evaluate1):
+    if eval_func is not evaluate1: return python_choose_move(board,player,depth,eval_func)
+    res=CkrSearchResult()
+    rc=_lib.ckr_search(to_native(board,player),depth,b"basic",0,ctypes.byref(res))
+    if rc!=0: raise RuntimeError(f"ckr_search failed: {rc}")
+    if res.best_move.length==0: return None,0
+    return move_from_native(res.best_move),res.nodes
+
+# --- فراخوانی دسته‌ای (یک عبور از مرز ctypes برای چند صفحه) ---
+# خطای هر صفحه با شماره آن صفحه به شکل RuntimeError گزارش می‌شود
+def check_batch(name,rc,codes):
+    if rc==0: return
+    bad=[(i,c) for i,c in enumerate(codes) if c<0]
+    raise RuntimeError(f"{name} failed: {rc}"+(f" (board {bad[0][0]}: {bad[0][1]})" if bad else ""))
+
+def legal_moves_batch(boards,player):
+    if _lib is None: return [get_moves(b,player) for b in boards]
+    n=len(boards)
+    packed=(ctypes.c_uint64*n)(*[to_native(b,player) for b in boards])
+    buf=(CkrMove*(n*MAX_MOVES))(); counts=(ctypes.c_int32*n)()
+    rc=_lib.ckr_legal_moves_batch(packed,n,buf,MAX_MOVES,counts)
+    if rc==CKR_ERROR_BUFFER: raise RuntimeError(f"more than {MAX_MOVES} moves in a position")
+    check_batch("ckr_legal_moves_batch",rc,counts)
+    return [[move_from_native(buf[i*MAX_MOVES+k]) for k in range(min(max(counts[i],0),MAX_MOVES))] for i in range(n)]
+
+# خروجی: (حرکت، امتیاز از دید player، گره‌ها) برای هر صفحه
+def search_batch(boards,player,depth=3,eval_name="basic",threads=0,movetime_ms=0):
+    if _lib is None:
+        return [(m,None,nodes) for m,nodes in (choose_move(b,player,depth) for b in boards)]
+    n=len(boards)
+    packed=(ctypes.c_uint64*n)(*[to_native(b,player) for b in boards])
+    results=(CkrSearchResult*n)(); statuses=(ctypes.c_int32*n)()
+    rc=_lib.ckr_search_batch(packed,n,depth,eval_name.encode(),movetime_ms,threads,results,statuses)
+    check_batch("ckr_search_batch",rc,statuses)
+    return [(move_from_native(r.best_move) if r.best_move.length else None,r.score,r.nodes) for r in results]
+
+python_choose_move=choose_move
+if _lib is not None and os.environ.get('CHECKERS_NATIVE')=='1':
+    get_moves,apply_move,is_terminal,choose_move=native_get_moves,native_apply_move,native_is_terminal,native_choose_move
+
 # --- بازی ---
 def play_game():
     board=init_board()
@@ -196,5 +327,5 @@ def play_game():
 
 # --- اجرا ---
 if __name__=="__main__":
-    print("شروع بازی 6x6 Checkers")
+    print("شروع بازی 6x6 Checkers", "(native engine)" if _lib is not None else "(pure Python)")
     play_game()